@@ -0,0 +1,74 @@
+//
+// Created by Koschei on 2025/2/20.
+//
+
+#include "arena.h"
+
+#include <cassert>
+#include <cstdint>
+
+Arena::Arena()
+    : alloc_ptr_(nullptr), alloc_bytes_remaining_(0), memory_usage_(0) {}
+
+Arena::~Arena() {
+  for (auto block : blocks_) {
+    delete[] block;
+  }
+}
+
+char* Arena::allocate(size_t bytes) {
+  assert(bytes > 0);
+  if (bytes <= alloc_bytes_remaining_) {
+    char* result = alloc_ptr_;
+    alloc_ptr_ += bytes;
+    alloc_bytes_remaining_ -= bytes;
+    return result;
+  }
+  return allocate_fallback(bytes);
+}
+
+char* Arena::allocate_aligned(size_t bytes, size_t alignment) {
+  assert((alignment & (alignment - 1)) == 0);
+  size_t current_mod =
+      reinterpret_cast<uintptr_t>(alloc_ptr_) & (alignment - 1);
+  size_t slop = (current_mod == 0 ? 0 : alignment - current_mod);
+  size_t needed = bytes + slop;
+  char* result;
+  if (needed <= alloc_bytes_remaining_) {
+    result = alloc_ptr_ + slop;
+    alloc_ptr_ += needed;
+    alloc_bytes_remaining_ -= needed;
+  } else {
+    // 新块由 new[] 分配，天然满足 max_align_t 对齐
+    assert(alignment <= alignof(std::max_align_t));
+    result = allocate_fallback(bytes);
+  }
+  assert((reinterpret_cast<uintptr_t>(result) & (alignment - 1)) == 0);
+  return result;
+}
+
+char* Arena::allocate_fallback(size_t bytes) {
+  if (bytes > kBlockSize / 4) {
+    // 大对象单独占一个块，避免浪费当前块的剩余空间
+    return allocate_new_block(bytes);
+  }
+  // 当前块剩余的空间直接丢弃
+  alloc_ptr_ = allocate_new_block(kBlockSize);
+  alloc_bytes_remaining_ = kBlockSize;
+
+  char* result = alloc_ptr_;
+  alloc_ptr_ += bytes;
+  alloc_bytes_remaining_ -= bytes;
+  return result;
+}
+
+char* Arena::allocate_new_block(size_t block_bytes) {
+  char* result = new char[block_bytes];
+  blocks_.push_back(result);
+  memory_usage_ += block_bytes + sizeof(char*);
+  return result;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+  return allocate_aligned(bytes == 0 ? 1 : bytes, alignment);
+}
@@ -0,0 +1,59 @@
+//
+// Created by Koschei on 2025/2/20.
+//
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// 参考 LevelDB 的 Arena：从大块内存中顺序切分（bump allocation），
+// 单个对象不单独释放，Arena 析构时整体归还。
+// 同时实现 std::pmr::memory_resource，使 std::pmr::string 等容器的
+// 字节也能落在 Arena 中。Arena 本身不是线程安全的。
+class Arena : public std::pmr::memory_resource {
+ public:
+  Arena();
+
+  Arena(const Arena&) = delete;
+
+  Arena& operator=(const Arena&) = delete;
+
+  ~Arena() override;
+
+  // 分配 bytes 字节，不保证对齐
+  char* allocate(size_t bytes);
+
+  // 分配 bytes 字节，起始地址按 alignment 对齐（alignment 须为 2 的幂）
+  char* allocate_aligned(size_t bytes,
+                         size_t alignment = alignof(std::max_align_t));
+
+  // Arena 向系统申请的全部内存（含块表开销），可用于判断何时 flush
+  size_t memory_usage() const { return memory_usage_; }
+
+ private:
+  static constexpr size_t kBlockSize = 4096;
+
+  char* allocate_fallback(size_t bytes);
+
+  char* allocate_new_block(size_t block_bytes);
+
+  void* do_allocate(size_t bytes, size_t alignment) override;
+
+  // 单个对象的内存不单独回收
+  void do_deallocate(void*, size_t, size_t) override {}
+
+  bool do_is_equal(const std::pmr::memory_resource& other) const
+      noexcept override {
+    return this == &other;
+  }
+
+  char* alloc_ptr_;               // 当前块中下一个可分配的位置
+  size_t alloc_bytes_remaining_;  // 当前块剩余字节数
+  std::vector<char*> blocks_;     // 所有已申请的块
+  size_t memory_usage_;
+};
+
+#endif  // ARENA_H
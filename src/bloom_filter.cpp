@@ -0,0 +1,27 @@
+//
+// Created by Koschei on 2025/3/4.
+//
+
+#include "bloom_filter.h"
+
+#include <algorithm>
+#include <cmath>
+
+BloomFilter::BloomFilter(size_t expected_keys, double bits_per_key)
+    : blocks_(std::max<size_t>(
+          1, static_cast<size_t>(std::ceil(
+                 static_cast<double>(std::max<size_t>(expected_keys, 1)) *
+                 bits_per_key / kBlockBits)))),
+      // 最优探测次数为 bits_per_key * ln(2)
+      probes_(std::clamp(static_cast<int>(std::lround(bits_per_key * 0.69)), 1,
+                         30)) {
+  for (auto& block : blocks_) {
+    for (auto& word : block.words) {
+      word.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+double BloomFilter::bits_per_key_for(double fp_rate) {
+  return -std::log(fp_rate) / (std::log(2.0) * std::log(2.0));
+}
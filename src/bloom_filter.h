@@ -0,0 +1,90 @@
+//
+// Created by Koschei on 2025/3/4.
+//
+
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 分块（cache line）布隆过滤器：位数组按 64 字节分块，
+// 一个键的 k 个探测位全部落在由哈希值选出的同一块内，
+// 每次 add/may_contain 最多访问一条缓存行。
+// 同样的位数下误判率高于标准布隆过滤器，每键位数越多差距越大
+// （每键 10 位时约 1.2% 对 0.8%，16 位时约 0.35% 对 0.05%）。
+// 只能添加不能删除。add 可与 may_contain 及其他 add 并发：
+// 位按原子 or 置位，读者不加锁，至多看不到尚未完成的 add
+class BloomFilter {
+ public:
+  // 按预计的键数和每键位数分配位数组，键数超出预计后误判率逐渐上升，
+  // 但不会漏报
+  BloomFilter(size_t expected_keys, double bits_per_key);
+
+  BloomFilter(const BloomFilter&) = delete;
+
+  BloomFilter& operator=(const BloomFilter&) = delete;
+
+  // 达到目标误判率 fp_rate 所需的每键位数：-ln(p) / ln(2)^2
+  static double bits_per_key_for(double fp_rate);
+
+  // hash 须为充分打散的 64 位哈希值
+  void add(uint64_t hash) {
+    uint64_t masks[kBlockWords] = {};
+    uint32_t h = static_cast<uint32_t>(hash);
+    uint32_t delta = (h >> 17) | (h << 15);  // 双重哈希的步长
+    for (int i = 0; i < probes_; ++i) {
+      uint32_t bit = h & (kBlockBits - 1);
+      masks[bit / 64] |= uint64_t{1} << (bit % 64);
+      h += delta;
+    }
+    auto& block = blocks_[block_index(hash)];
+    for (size_t i = 0; i < kBlockWords; ++i) {
+      if (masks[i] != 0) {
+        block.words[i].fetch_or(masks[i], std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // 返回 false 时 hash 对应的键一定没有添加过
+  bool may_contain(uint64_t hash) const {
+    const auto& block = blocks_[block_index(hash)];
+    uint32_t h = static_cast<uint32_t>(hash);
+    uint32_t delta = (h >> 17) | (h << 15);
+    for (int i = 0; i < probes_; ++i) {
+      uint32_t bit = h & (kBlockBits - 1);
+      if ((block.words[bit / 64].load(std::memory_order_relaxed) &
+           (uint64_t{1} << (bit % 64))) == 0) {
+        return false;
+      }
+      h += delta;
+    }
+    return true;
+  }
+
+  // 位数组占用的内存
+  size_t memory_usage() const { return blocks_.size() * sizeof(Block); }
+
+  int get_probes() const { return probes_; }
+
+ private:
+  static constexpr uint32_t kBlockBits = 512;
+  static constexpr size_t kBlockWords = kBlockBits / 64;
+
+  struct alignas(64) Block {
+    std::atomic<uint64_t> words[kBlockWords];
+  };
+
+  // 用哈希的高 32 位选块：(h * n) >> 32 把 [0, 2^32) 均匀映射到 [0, n)，
+  // 低 32 位留给块内的探测位
+  size_t block_index(uint64_t hash) const {
+    return static_cast<size_t>(((hash >> 32) * blocks_.size()) >> 32);
+  }
+
+  std::vector<Block> blocks_;
+  int probes_;  // 每个键置位的个数 k
+};
+
+#endif  // BLOOM_FILTER_H
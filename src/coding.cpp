@@ -0,0 +1,63 @@
+//
+// Created by Koschei on 2025/3/2.
+//
+
+#include "coding.h"
+
+#include <array>
+
+void put_varint64(std::string* out, uint64_t v) {
+  while (v >= 0x80) {
+    out->push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  out->push_back(static_cast<char>(v));
+}
+
+bool get_varint64(const char** p, const char* limit, uint64_t* v) {
+  uint64_t result = 0;
+  for (int shift = 0; shift <= 63 && *p < limit; shift += 7) {
+    auto byte = static_cast<uint8_t>(*(*p)++);
+    result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      *v = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t crc32c(const char* data, size_t size) {
+  // slicing-by-8：table[k][b] 为字节 b 之后再跟 k 个零字节的 CRC，
+  // 每次查 8 张表处理 8 个字节，多项式取反射形式
+  static const auto table = [] {
+    std::array<std::array<uint32_t, 256>, 8> t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+      }
+      t[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+      for (int k = 1; k < 8; ++k) {
+        t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+      }
+    }
+    return t;
+  }();
+  auto p = reinterpret_cast<const uint8_t*>(data);
+  uint32_t crc = ~0u;
+  for (; size >= 8; size -= 8, p += 8) {
+    uint32_t lo = get_fixed32(reinterpret_cast<const char*>(p)) ^ crc;
+    uint32_t hi = get_fixed32(reinterpret_cast<const char*>(p) + 4);
+    crc = table[7][lo & 0xFF] ^ table[6][(lo >> 8) & 0xFF] ^
+          table[5][(lo >> 16) & 0xFF] ^ table[4][lo >> 24] ^
+          table[3][hi & 0xFF] ^ table[2][(hi >> 8) & 0xFF] ^
+          table[1][(hi >> 16) & 0xFF] ^ table[0][hi >> 24];
+  }
+  for (; size > 0; --size, ++p) {
+    crc = table[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
@@ -0,0 +1,44 @@
+//
+// Created by Koschei on 2025/3/2.
+//
+
+#ifndef CODING_H
+#define CODING_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// 日志与表文件共用的编码工具，整数一律按小端序存放
+
+inline void put_fixed32(std::string* out, uint32_t v) {
+  out->append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+inline void put_fixed64(std::string* out, uint64_t v) {
+  out->append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+inline uint32_t get_fixed32(const char* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t get_fixed64(const char* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// 变长整数：每字节低 7 位存数据，最高位表示后面还有字节
+void put_varint64(std::string* out, uint64_t v);
+
+// 从 [*p, limit) 解析一个变长整数并前移 *p，数据不完整时返回 false
+bool get_varint64(const char** p, const char* limit, uint64_t* v);
+
+// CRC32C（Castagnoli）
+uint32_t crc32c(const char* data, size_t size);
+
+#endif  // CODING_H
@@ -0,0 +1,224 @@
+//
+// Created by Koschei on 2025/2/22.
+//
+
+#include "concurrent_skiplist.h"
+
+#include <random>
+#include <vector>
+
+template <typename Key, typename Value, class Comparator>
+ConcurrentSkipList<Key, Value, Comparator>::ConcurrentSkipList(Comparator cmp,
+                                                               int max_level,
+                                                               float prob)
+    : size_bytes_(0),
+      erased_count_(0),
+      max_level_(max_level),
+      current_level_(1),
+      level_generator_(max_level, prob),
+      compare_(cmp) {
+  header_ = Node::create({}, max_level_);
+}
+
+template <typename Key, typename Value, class Comparator>
+ConcurrentSkipList<Key, Value, Comparator>::~ConcurrentSkipList() {
+  auto current = header_->next(0);
+  while (current != nullptr) {
+    auto next = current->next(0);
+    Node::destroy(current);
+    current = next;
+  }
+  Node::destroy(header_);
+  // 退休队列中的值随 epoch_ 析构一并释放
+}
+
+template <typename Key, typename Value, class Comparator>
+int ConcurrentSkipList<Key, Value, Comparator>::random_level() const {
+  // 每个线程持有自己的随机数发生器，避免共享状态上的竞争
+  thread_local Random64 rng(std::random_device{}());
+  return level_generator_.level(rng.next());
+}
+
+template <typename Key, typename Value, class Comparator>
+ConcurrentSkipListNode<Key, Value>*
+ConcurrentSkipList<Key, Value, Comparator>::find_greater_or_equal(
+    const Key& key) const {
+  auto current = header_;
+  Node* next = nullptr;
+  for (int level = current_level_.load(std::memory_order_relaxed) - 1;
+       level >= 0; --level) {
+    next = current->next(level);
+    while (next && compare_(next->key_, key) < 0) {
+      current = next;
+      next = current->next(level);
+    }
+  }
+  return next;
+}
+
+template <typename Key, typename Value, class Comparator>
+ConcurrentSkipListNode<Key, Value>*
+ConcurrentSkipList<Key, Value, Comparator>::find_node(const Key& key) const {
+  auto node = find_greater_or_equal(key);
+  return node && compare_(node->key_, key) == 0 ? node : nullptr;
+}
+
+template <typename Key, typename Value, class Comparator>
+void ConcurrentSkipList<Key, Value, Comparator>::find_splice_for_level(
+    const Key& key, int level, Node** before, Node** after) const {
+  auto current = *before;
+  auto next = current->next(level);
+  while (next && compare_(next->key_, key) < 0) {
+    current = next;
+    next = current->next(level);
+  }
+  *before = current;
+  *after = next;
+}
+
+template <typename Key, typename Value, class Comparator>
+void ConcurrentSkipList<Key, Value, Comparator>::retire(Value* value) {
+  epoch_.retire(value, &ConcurrentSkipList::free_retired, nullptr,
+                sizeof(Value) + SkipListSizeTraits<Value>::heap_size(*value));
+}
+
+template <typename Key, typename Value, class Comparator>
+void ConcurrentSkipList<Key, Value, Comparator>::insert(Key key, Value value) {
+  // 每层的插入位置：prev[level]->key_ < key <= next[level]->key_
+  std::vector<Node*> prev(max_level_, nullptr);
+  std::vector<Node*> next(max_level_, nullptr);
+  int top_level = current_level_.load(std::memory_order_relaxed);
+  auto before = header_;
+  for (int level = top_level - 1; level >= 0; --level) {
+    find_splice_for_level(key, level, &before, &next[level]);
+    prev[level] = before;
+  }
+
+  size_t key_length = SkipListSizeTraits<Key>::size(key);
+  size_t value_length = SkipListSizeTraits<Value>::size(value);
+  auto new_value = new Value(std::move(value));
+
+  // 替换已有节点的值；节点处于逻辑删除状态时相当于重新插入
+  auto replace_value = [&](Node* node) {
+    auto old_value =
+        node->value_.exchange(new_value, std::memory_order_acq_rel);
+    size_bytes_.fetch_add(value_length, std::memory_order_relaxed);
+    if (old_value == nullptr) {
+      size_bytes_.fetch_add(key_length, std::memory_order_relaxed);
+      erased_count_.fetch_sub(1, std::memory_order_relaxed);
+    } else {
+      size_bytes_.fetch_sub(SkipListSizeTraits<Value>::size(*old_value),
+                            std::memory_order_relaxed);
+      retire(old_value);
+    }
+  };
+
+  if (next[0] && compare_(next[0]->key_, key) == 0) {
+    replace_value(next[0]);
+    return;
+  }
+
+  int new_level = random_level();
+  for (int level = top_level; level < new_level; ++level) {
+    prev[level] = header_;
+    next[level] = nullptr;
+  }
+  // 抬高当前层数；与其他线程竞争失败时，更高层的插入位置会在 CAS 时修正
+  while (new_level > top_level &&
+         !current_level_.compare_exchange_weak(top_level, new_level,
+                                               std::memory_order_relaxed)) {
+  }
+
+  auto new_node = Node::create(std::move(key), new_level);
+  new_node->value_.store(new_value, std::memory_order_relaxed);
+  // 自底向上逐层链入：第 0 层链入成功即对读者可见
+  for (int level = 0; level < new_level; ++level) {
+    while (true) {
+      new_node->relaxed_set_next(level, next[level]);
+      if (prev[level]->cas_next(level, next[level], new_node)) {
+        break;
+      }
+      // CAS 失败说明该层有其他线程插入，从 prev[level] 出发重新定位
+      find_splice_for_level(new_node->key_, level, &prev[level],
+                            &next[level]);
+      if (level == 0 && next[0] &&
+          compare_(next[0]->key_, new_node->key_) == 0) {
+        // 其他线程抢先插入了同一个键：丢弃新节点，改为替换其值
+        new_node->value_.store(nullptr, std::memory_order_relaxed);
+        Node::destroy(new_node);
+        replace_value(next[0]);
+        return;
+      }
+    }
+  }
+  size_bytes_.fetch_add(key_length + value_length, std::memory_order_relaxed);
+}
+
+template <typename Key, typename Value, class Comparator>
+void ConcurrentSkipList<Key, Value, Comparator>::erase(const Key& key) {
+  auto node = find_node(key);
+  if (node != nullptr) {
+    auto old_value =
+        node->value_.exchange(nullptr, std::memory_order_acq_rel);
+    if (old_value != nullptr) {
+      size_bytes_.fetch_sub(SkipListSizeTraits<Key>::size(key) +
+                                SkipListSizeTraits<Value>::size(*old_value),
+                            std::memory_order_relaxed);
+      erased_count_.fetch_add(1, std::memory_order_relaxed);
+      retire(old_value);
+    }
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+std::optional<Value> ConcurrentSkipList<Key, Value, Comparator>::get(
+    const Key& key) const {
+  // 查找和复制值期间登记 epoch，防止节点被 purge 或值被并发替换后释放
+  auto guard = epoch_.pin();
+  auto node = find_node(key);
+  if (node != nullptr) {
+    auto value = node->value_.load(std::memory_order_acquire);
+    if (value != nullptr) {
+      return *value;
+    }
+  }
+  return {};
+}
+
+template <typename Key, typename Value, class Comparator>
+bool ConcurrentSkipList<Key, Value, Comparator>::contains(
+    const Key& key) const {
+  auto guard = epoch_.pin();
+  auto node = find_node(key);
+  return node != nullptr &&
+         node->value_.load(std::memory_order_acquire) != nullptr;
+}
+
+template <typename Key, typename Value, class Comparator>
+void ConcurrentSkipList<Key, Value, Comparator>::purge() {
+  // 没有并发写入，被 erase 的节点的值保持为空。自顶向下逐层摘除，
+  // 节点自身的前向指针不变，正停在节点上的读者仍能继续向后走
+  std::vector<Node*> erased;
+  for (int level = current_level_.load(std::memory_order_relaxed) - 1;
+       level >= 0; --level) {
+    auto prev = header_;
+    for (auto node = prev->next(level); node != nullptr;
+         node = node->next(level)) {
+      if (node->value_.load(std::memory_order_relaxed) != nullptr) {
+        prev = node;
+        continue;
+      }
+      prev->set_next(level, node->next(level));
+      if (level == 0) {
+        erased.push_back(node);
+      }
+    }
+  }
+  // 所有层都摘除之后才退休，之后登记的读者不会再走到这些节点
+  for (auto node : erased) {
+    epoch_.retire(node, &ConcurrentSkipList::free_retired_node, nullptr,
+                  Node::alloc_size(node->level_) +
+                      SkipListSizeTraits<Key>::heap_size(node->key_));
+  }
+  erased_count_.fetch_sub(erased.size(), std::memory_order_relaxed);
+}
@@ -0,0 +1,154 @@
+//
+// Created by Koschei on 2025/2/22.
+//
+
+#ifndef CONCURRENT_SKIPLIST_H
+#define CONCURRENT_SKIPLIST_H
+
+#include <atomic>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include "epoch.h"
+#include "random.h"
+#include "skiplist.h"
+
+template <typename Key, typename Value>
+struct ConcurrentSkipListNode {
+  const Key key_;              // 节点存储的键，链入后不再修改
+  std::atomic<Value*> value_;  // 节点存储的值，为空表示已被 erase
+  int level_;                  // 塔高，即 forward_ 的实际长度
+  std::atomic<ConcurrentSkipListNode*> forward_[1];  // 按塔高在尾部分配
+
+  static ConcurrentSkipListNode* create(Key key, int level) {
+    void* mem = ::operator new(alloc_size(level));
+    return new (mem) ConcurrentSkipListNode(std::move(key), level);
+  }
+
+  static void destroy(ConcurrentSkipListNode* node) {
+    delete node->value_.load(std::memory_order_relaxed);
+    node->~ConcurrentSkipListNode();
+    ::operator delete(node);
+  }
+
+  static size_t alloc_size(int level) {
+    return sizeof(ConcurrentSkipListNode) +
+           sizeof(std::atomic<ConcurrentSkipListNode*>) * (level - 1);
+  }
+
+  // acquire 读保证能看到后继节点完整初始化后的内容
+  ConcurrentSkipListNode* next(int level) const {
+    return forward_[level].load(std::memory_order_acquire);
+  }
+
+  // 节点尚未发布时使用，不需要内存屏障
+  void relaxed_set_next(int level, ConcurrentSkipListNode* node) {
+    forward_[level].store(node, std::memory_order_relaxed);
+  }
+
+  // 写者独占时使用，release 写保证读者能看到 node 完整初始化后的内容
+  void set_next(int level, ConcurrentSkipListNode* node) {
+    forward_[level].store(node, std::memory_order_release);
+  }
+
+  bool cas_next(int level, ConcurrentSkipListNode* expected,
+                ConcurrentSkipListNode* node) {
+    return forward_[level].compare_exchange_strong(expected, node,
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed);
+  }
+
+ private:
+  ConcurrentSkipListNode(Key key, int level)
+      : key_(std::move(key)), value_(nullptr), level_(level) {
+    for (int i = 0; i < level; ++i) {
+      new (&forward_[i]) std::atomic<ConcurrentSkipListNode*>(nullptr);
+    }
+  }
+};
+
+// 支持多线程并发读写的跳表，接口与 SkipList 保持一致：
+// - insert 自底向上逐层 CAS 链入新节点，无锁
+// - get/contains 只做 acquire 读，不加锁（lock-free）：查找不重试，
+//   但开始前要在 EpochManager 登记，登记至多扫描一遍 epoch 槽位，
+//   与本线程的槽位共用时的 CAS 可能因并发释放而重试，因此不是 wait-free
+// - erase 为逻辑删除：原子地把值指针置空，节点保留在链表中，
+//   同一个键再次 insert 时直接复用该节点
+// 被替换或删除的值交给 EpochManager，等到没有读者能看到时再释放，
+// 读者在 get/contains 期间登记 epoch，因此访问的节点和值指针始终有效。
+// 限制：erase 不摘除节点，节点数以插入过的不同键数为上限，
+// 删除后不再插入的键的节点一直占用内存（见 get_erased_count）。
+// 没有并发写入时可调用 purge 摘除这些节点，读者可与 purge 并发。
+template <typename Key, typename Value, class Comparator>
+class ConcurrentSkipList {
+ public:
+  explicit ConcurrentSkipList(Comparator cmp, int max_level = 16,
+                              float prob = 0.5);
+
+  ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+
+  ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+
+  ~ConcurrentSkipList();
+
+  void insert(Key key, Value value);
+
+  void erase(const Key& key);
+
+  std::optional<Value> get(const Key& key) const;
+
+  // 只检查节点的值是否存在，不复制值
+  bool contains(const Key& key) const;
+
+  // 摘除所有被 erase 的节点，交给 EpochManager 延迟释放。
+  // 不能与 insert/erase 并发，可与 get/contains 并发
+  void purge();
+
+  // 已被 erase、尚未摘除的节点数
+  size_t get_erased_count() const {
+    return erased_count_.load(std::memory_order_relaxed);
+  }
+
+  size_t get_size() const {
+    return size_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  using Node = ConcurrentSkipListNode<Key, Value>;
+
+  std::atomic<size_t> size_bytes_;
+  std::atomic<size_t> erased_count_;
+  int max_level_;
+  std::atomic<int> current_level_;
+  LevelGenerator level_generator_;
+  Node* header_;
+  mutable EpochManager epoch_;
+
+  Comparator const compare_;
+
+  int random_level() const;
+
+  // 返回第一个 >= key 的节点，找不到返回 nullptr
+  Node* find_greater_or_equal(const Key& key) const;
+
+  // 返回键等于 key 的节点（可能已被 erase），找不到返回 nullptr
+  Node* find_node(const Key& key) const;
+
+  // 从 before 出发，在 level 层找到 key 的插入位置：
+  // before->key_ < key <= after->key_（after 可能为空）
+  void find_splice_for_level(const Key& key, int level, Node** before,
+                             Node** after) const;
+
+  void retire(Value* value);
+
+  static void free_retired(void* value, void*) {
+    delete static_cast<Value*>(value);
+  }
+
+  static void free_retired_node(void* node, void*) {
+    Node::destroy(static_cast<Node*>(node));
+  }
+};
+
+#endif  // CONCURRENT_SKIPLIST_H
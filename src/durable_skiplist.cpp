@@ -0,0 +1,65 @@
+//
+// Created by Koschei on 2025/3/1.
+//
+
+#include "durable_skiplist.h"
+
+#include <type_traits>
+
+template <typename Key, typename Value, class Comparator>
+DurableSkipList<Key, Value, Comparator>::DurableSkipList(
+    Comparator cmp, const std::string& path, const WalOptions& wal_options,
+    const SkipListOptions& options)
+    : list_(cmp, reader_options(options)),
+      wal_(path, wal_options,
+           [this](WriteAheadLog::RecordType type, std::string_view key,
+                  std::string_view value) { replay(type, key, value); }) {
+  flush_pending();
+  pending_.shrink_to_fit();
+}
+
+template <typename Key, typename Value, class Comparator>
+void DurableSkipList<Key, Value, Comparator>::replay(
+    WriteAheadLog::RecordType type, std::string_view key,
+    std::string_view value) {
+  if (type == WriteAheadLog::RecordType::kInsert) {
+    if constexpr (std::is_same_v<Key, std::string_view> ||
+                  std::is_same_v<Value, std::string_view>) {
+      // 解码出的视图指向回放缓冲区，不能攒到回放结束，
+      // 直接插入（节点内联拷贝字节）
+      list_.insert(WalCodec<Key>::decode(key), WalCodec<Value>::decode(value));
+    } else {
+      pending_.emplace_back(WalCodec<Key>::decode(key),
+                            WalCodec<Value>::decode(value));
+    }
+    return;
+  }
+  // erase 之前的 insert 须先生效
+  flush_pending();
+  list_.erase(WalCodec<Key>::decode(key));
+}
+
+template <typename Key, typename Value, class Comparator>
+void DurableSkipList<Key, Value, Comparator>::flush_pending() {
+  list_.insert_batch(pending_.begin(), pending_.end());
+  pending_.clear();
+}
+
+template <typename Key, typename Value, class Comparator>
+void DurableSkipList<Key, Value, Comparator>::insert(const Key& key,
+                                                     const Value& value) {
+  std::string key_bytes;
+  std::string value_bytes;
+  WalCodec<Key>::encode(key, &key_bytes);
+  WalCodec<Value>::encode(value, &value_bytes);
+  wal_.append(WriteAheadLog::RecordType::kInsert, key_bytes, value_bytes,
+              [&] { list_.insert(key, value); });
+}
+
+template <typename Key, typename Value, class Comparator>
+void DurableSkipList<Key, Value, Comparator>::erase(const Key& key) {
+  std::string key_bytes;
+  WalCodec<Key>::encode(key, &key_bytes);
+  wal_.append(WriteAheadLog::RecordType::kErase, key_bytes, {},
+              [&] { list_.erase(key); });
+}
@@ -0,0 +1,67 @@
+//
+// Created by Koschei on 2025/3/1.
+//
+
+#ifndef DURABLE_SKIPLIST_H
+#define DURABLE_SKIPLIST_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "skiplist.h"
+#include "wal.h"
+
+// 以预写日志保证持久性的跳表：insert/erase 先追加到日志，
+// 再由组提交的 leader 按日志顺序写入跳表。构造时先回放已有日志，
+// 连续的 insert 经 insert_batch 批量写入，遇到 erase 时先提交之前的批次。
+// 写操作可以多线程并发调用；跳表以单写多读模式运行，读操作不加锁。
+// 键值与日志字节的转换见 WalCodec
+template <typename Key, typename Value, class Comparator>
+class DurableSkipList {
+ public:
+  using List = SkipList<Key, Value, Comparator>;
+
+  DurableSkipList(Comparator cmp, const std::string& path,
+                  const WalOptions& wal_options = {},
+                  const SkipListOptions& options = {});
+
+  DurableSkipList(const DurableSkipList&) = delete;
+
+  DurableSkipList& operator=(const DurableSkipList&) = delete;
+
+  void insert(const Key& key, const Value& value);
+
+  void erase(const Key& key);
+
+  std::optional<Value> get(const Key& key) const { return list_.get(key); }
+
+  bool contains(const Key& key) const { return list_.contains(key); }
+
+  // 遍历等其他只读操作，不能与写操作并发修改同一个迭代器
+  const List& list() const { return list_; }
+
+  WriteAheadLog& wal() { return wal_; }
+
+ private:
+  static SkipListOptions reader_options(SkipListOptions options) {
+    options.concurrent_readers = true;
+    return options;
+  }
+
+  // 日志回放的回调
+  void replay(WriteAheadLog::RecordType type, std::string_view key,
+              std::string_view value);
+
+  // 把攒下的连续 insert 一次写入跳表
+  void flush_pending();
+
+  List list_;
+  // 回放时攒批的连续 insert，回放结束后清空
+  std::vector<std::pair<Key, Value>> pending_;
+  WriteAheadLog wal_;  // 须在 list_ 和 pending_ 之后构造
+};
+
+#endif  // DURABLE_SKIPLIST_H
@@ -0,0 +1,145 @@
+//
+// Created by Koschei on 2025/2/24.
+//
+
+#include "epoch.h"
+
+#include <functional>
+#include <thread>
+
+EpochManager::Guard& EpochManager::Guard::operator=(Guard&& other) noexcept {
+  if (this != &other) {
+    release();
+    slot_ = other.slot_;
+    other.slot_ = nullptr;
+  }
+  return *this;
+}
+
+void EpochManager::Guard::release() {
+  if (slot_ != nullptr) {
+    if (slot_->depth_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      slot_->owner_.store(std::thread::id(), std::memory_order_relaxed);
+      slot_->epoch_.store(kInactive, std::memory_order_release);
+    }
+    slot_ = nullptr;
+  }
+}
+
+EpochManager::EpochManager()
+    : global_epoch_(0),
+      retires_since_reclaim_(0),
+      retired_bytes_(0),
+      peak_retired_bytes_(0) {}
+
+EpochManager::~EpochManager() {
+  for (auto& retired : retired_) {
+    retired.deleter_(retired.ptr_, retired.context_);
+  }
+}
+
+EpochManager::Guard EpochManager::pin() {
+  // 从与线程相关的位置开始找空闲槽位，减少读者之间的冲突
+  thread_local const std::thread::id id = std::this_thread::get_id();
+  thread_local const size_t hint = std::hash<std::thread::id>{}(id);
+  size_t owned = 0;
+  Slot* own = nullptr;
+  for (size_t i = 0; i < kMaxReaders; ++i) {
+    auto& slot = slots_[(hint + i) % kMaxReaders];
+    uint64_t expected = kInactive;
+    if (slot.epoch_.load(std::memory_order_relaxed) == kInactive &&
+        slot.epoch_.compare_exchange_strong(
+            expected, global_epoch_.load(std::memory_order_seq_cst),
+            std::memory_order_acquire, std::memory_order_relaxed)) {
+      slot.owner_.store(id, std::memory_order_relaxed);
+      slot.depth_.store(1, std::memory_order_relaxed);
+      // 与 reclaim 中的屏障配对：要么回收者看到本次登记，
+      // 要么本读者之后的读取能看到回收者之前对节点的摘除
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      return Guard(&slot);
+    }
+    if (slot.owner_.load(std::memory_order_relaxed) == id) {
+      own = &slot;
+      if (++owned >= kSlotsPerThread && join(own)) {
+        return Guard(own);
+      }
+    }
+  }
+  // 槽位用尽
+  if (own != nullptr && join(own)) {
+    return Guard(own);
+  }
+  // 登记到溢出槽位，不等待。溢出槽位只计数，不记录 epoch，
+  // reclaim 看到它非空时视为有读者停在最旧的 epoch，不释放任何对象
+  overflow_.depth_.fetch_add(1, std::memory_order_seq_cst);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  return Guard(&overflow_);
+}
+
+bool EpochManager::join(Slot* slot) {
+  // 共用的槽位登记的 epoch 不晚于当前，保护范围只会更大。
+  // depth_ 已降为 0 的槽位正在撤销登记，不能再加入
+  size_t depth = slot->depth_.load(std::memory_order_relaxed);
+  while (depth != 0) {
+    if (slot->depth_.compare_exchange_weak(depth, depth + 1,
+                                           std::memory_order_relaxed)) {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      return true;
+    }
+  }
+  return false;
+}
+
+void EpochManager::retire(void* ptr, Deleter deleter, void* context,
+                          size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  retired_.push_back({ptr, deleter, context, bytes,
+                      global_epoch_.load(std::memory_order_seq_cst)});
+  auto retired_bytes =
+      retired_bytes_.load(std::memory_order_relaxed) + bytes;
+  retired_bytes_.store(retired_bytes, std::memory_order_relaxed);
+  if (retired_bytes > peak_retired_bytes_.load(std::memory_order_relaxed)) {
+    peak_retired_bytes_.store(retired_bytes, std::memory_order_relaxed);
+  }
+  if (++retires_since_reclaim_ >= kReclaimInterval) {
+    reclaim_locked();
+  }
+}
+
+void EpochManager::reclaim() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  reclaim_locked();
+}
+
+void EpochManager::reclaim_locked() {
+  retires_since_reclaim_ = 0;
+  if (retired_.empty()) {
+    return;
+  }
+  // 推进之后登记的读者 epoch 一定大于队列中所有对象的退休 epoch，
+  // 它们开始读取时这些对象已经被摘除，看不到了
+  global_epoch_.fetch_add(1, std::memory_order_seq_cst);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  uint64_t min_epoch = kInactive;
+  if (overflow_.depth_.load(std::memory_order_acquire) != 0) {
+    return;
+  }
+  for (auto& slot : slots_) {
+    auto epoch = slot.epoch_.load(std::memory_order_acquire);
+    if (epoch < min_epoch) {
+      min_epoch = epoch;
+    }
+  }
+
+  size_t freed_bytes = 0;
+  while (!retired_.empty() && retired_.front().epoch_ < min_epoch) {
+    auto& retired = retired_.front();
+    retired.deleter_(retired.ptr_, retired.context_);
+    freed_bytes += retired.bytes_;
+    retired_.pop_front();
+  }
+  retired_bytes_.store(
+      retired_bytes_.load(std::memory_order_relaxed) - freed_bytes,
+      std::memory_order_relaxed);
+}
@@ -0,0 +1,124 @@
+//
+// Created by Koschei on 2025/2/24.
+//
+
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// 基于 epoch 的安全内存回收（EBR）：
+// - 读者在访问共享节点前通过 pin() 登记当前全局 epoch，离开时撤销登记
+// - 写者摘除节点后调用 retire()，节点连同当时的全局 epoch 进入退休队列
+// - 回收时推进全局 epoch，所有已登记读者的 epoch 都大于节点的退休 epoch
+//   时，说明不再有读者能看到该节点，才真正释放
+// 读者登记只占用一个槽位，不加锁，pin 至多扫描一遍槽位、不会等待；
+// retire 与回收由互斥锁保护。
+class EpochManager {
+  struct Slot;
+
+ public:
+  // 释放函数：ptr 为退休对象，context 为 retire 时传入的附加参数
+  using Deleter = void (*)(void* ptr, void* context);
+
+  // 读者临界区，析构时撤销登记
+  class Guard {
+   public:
+    Guard(Guard&& other) noexcept : slot_(other.slot_) {
+      other.slot_ = nullptr;
+    }
+
+    Guard(const Guard&) = delete;
+
+    Guard& operator=(const Guard&) = delete;
+
+    Guard& operator=(Guard&& other) noexcept;
+
+    ~Guard() { release(); }
+
+   private:
+    friend class EpochManager;
+
+    explicit Guard(Slot* slot) : slot_(slot) {}
+
+    void release();
+
+    Slot* slot_;
+  };
+
+  EpochManager();
+
+  EpochManager(const EpochManager&) = delete;
+
+  EpochManager& operator=(const EpochManager&) = delete;
+
+  // 释放所有仍在退休队列中的对象，调用时不能再有读者
+  ~EpochManager();
+
+  Guard pin();
+
+  // bytes 仅用于统计退休队列占用的内存
+  void retire(void* ptr, Deleter deleter, void* context, size_t bytes);
+
+  // 推进 epoch 并释放所有读者都不可见的对象
+  void reclaim();
+
+  size_t retired_bytes() const {
+    return retired_bytes_.load(std::memory_order_relaxed);
+  }
+
+  size_t peak_retired_bytes() const {
+    return peak_retired_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // 槽位数。槽位全被占用时，没有槽位的线程登记到溢出槽位：
+  // 不会等待，但溢出槽位非空期间 reclaim 不释放任何对象
+  static constexpr size_t kMaxReaders = 128;
+  // 一个线程最多独占的槽位数：再嵌套 pin（如同时存活多个迭代器）时
+  // 与自己的槽位共用，按嵌套计数，因此一个线程可以同时持有任意多个 Guard，
+  // 也不会占满槽位使其他线程无法登记
+  static constexpr size_t kSlotsPerThread = 4;
+  // 每退休这么多个对象尝试回收一次
+  static constexpr size_t kReclaimInterval = 64;
+  static constexpr uint64_t kInactive = UINT64_MAX;
+
+  struct Retired {
+    void* ptr_;
+    Deleter deleter_;
+    void* context_;
+    size_t bytes_;
+    uint64_t epoch_;
+  };
+
+  // 每个槽位独占一个缓存行，避免读者之间的伪共享
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> epoch_{kInactive};
+    // 登记该槽位的线程，用于槽位用尽时找到本线程的槽位
+    std::atomic<std::thread::id> owner_{};
+    // 共用该槽位的 Guard 数，降为 0 时撤销登记
+    std::atomic<size_t> depth_{0};
+  };
+
+  // 在 slot 上嵌套登记，slot 正在撤销登记时返回 false
+  static bool join(Slot* slot);
+
+  void reclaim_locked();
+
+  std::atomic<uint64_t> global_epoch_;
+  Slot slots_[kMaxReaders];
+  Slot overflow_;  // 只用 depth_ 计数，epoch_ 始终为 kInactive
+
+  std::mutex mutex_;             // 保护 retired_
+  std::deque<Retired> retired_;  // 按退休 epoch 递增排列
+  size_t retires_since_reclaim_;
+  std::atomic<size_t> retired_bytes_;
+  std::atomic<size_t> peak_retired_bytes_;
+};
+
+#endif  // EPOCH_H
@@ -0,0 +1,105 @@
+//
+// Created by Koschei on 2025/3/5.
+//
+
+#include "hash_index.h"
+
+namespace {
+
+// 能容纳 n 个已用槽位（不超过 3/4）的最小容量
+size_t capacity_for(size_t n, size_t min_capacity) {
+  size_t capacity = min_capacity;
+  while (capacity / 4 * 3 < n) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+}  // namespace
+
+HashIndex::HashIndex(EpochManager* epoch)
+    : epoch_(epoch),
+      table_(new Table(kMinCapacity)),
+      live_(0),
+      used_(0),
+      memory_bytes_(table_.load(std::memory_order_relaxed)->bytes()) {}
+
+HashIndex::~HashIndex() { delete table_.load(std::memory_order_relaxed); }
+
+void HashIndex::insert(uint64_t hash, void* node) {
+  Table* table = table_.load(std::memory_order_relaxed);
+  if (used_ + 1 > table->slots.size() / 4 * 3) {
+    // 重建后负载不超过 1/2，之后至少还能插入容量的 1/4 才再次重建
+    rehash(capacity_for((live_ + 1) * 3 / 2, kMinCapacity));
+    table = table_.load(std::memory_order_relaxed);
+  }
+  for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+    Slot& slot = table->slots[i];
+    void* current = slot.node.load(std::memory_order_relaxed);
+    if (current == nullptr || current == tombstone()) {
+      if (current == nullptr) {
+        ++used_;
+      }
+      // 先写哈希，再以 release 发布节点
+      slot.hash.store(hash, std::memory_order_relaxed);
+      slot.node.store(node, std::memory_order_release);
+      ++live_;
+      return;
+    }
+  }
+}
+
+void HashIndex::replace(uint64_t hash, void* old_node, void* new_node) {
+  find_slot(hash, old_node)->node.store(new_node, std::memory_order_release);
+}
+
+void HashIndex::erase(uint64_t hash, void* node) {
+  find_slot(hash, node)->node.store(tombstone(), std::memory_order_release);
+  --live_;
+}
+
+void HashIndex::reserve(size_t n) {
+  size_t capacity = capacity_for(n, kMinCapacity);
+  if (capacity > table_.load(std::memory_order_relaxed)->slots.size()) {
+    rehash(capacity);
+  }
+}
+
+HashIndex::Slot* HashIndex::find_slot(uint64_t hash, const void* node) const {
+  Table* table = table_.load(std::memory_order_relaxed);
+  for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+    Slot& slot = table->slots[i];
+    if (slot.node.load(std::memory_order_relaxed) == node) {
+      return &slot;
+    }
+  }
+}
+
+void HashIndex::rehash(size_t capacity) {
+  Table* old_table = table_.load(std::memory_order_relaxed);
+  auto table = new Table(capacity);
+  // 新表尚未发布，不需要内存屏障
+  for (const Slot& slot : old_table->slots) {
+    void* node = slot.node.load(std::memory_order_relaxed);
+    if (node == nullptr || node == tombstone()) {
+      continue;
+    }
+    uint64_t hash = slot.hash.load(std::memory_order_relaxed);
+    size_t i = hash & table->mask;
+    while (table->slots[i].node.load(std::memory_order_relaxed) != nullptr) {
+      i = (i + 1) & table->mask;
+    }
+    table->slots[i].hash.store(hash, std::memory_order_relaxed);
+    table->slots[i].node.store(node, std::memory_order_relaxed);
+  }
+  used_ = live_;
+  memory_bytes_ = table->bytes();
+  table_.store(table, std::memory_order_release);
+  if (epoch_ != nullptr) {
+    // 读者可能仍在旧表上探测
+    epoch_->retire(old_table, &HashIndex::free_table, nullptr,
+                   old_table->bytes());
+  } else {
+    delete old_table;
+  }
+}
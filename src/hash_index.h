@@ -0,0 +1,106 @@
+//
+// Created by Koschei on 2025/3/5.
+//
+
+#ifndef HASH_INDEX_H
+#define HASH_INDEX_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "epoch.h"
+
+// 哈希值 -> 节点指针的开放寻址（线性探测）哈希表，作为有序结构旁的点查索引。
+// 每个槽位存放完整的 64 位哈希和节点指针，探测时先比较哈希，
+// 相同时才交给调用方比较节点的键，冲突的槽位不会访问节点。
+// 删除留下墓碑，有效节点与墓碑之和超过容量的 3/4 时重建：
+// 新表建好后整体发布，旧表交给 EpochManager 延迟释放。
+// 单写多读：insert/replace/erase 须串行调用，find 可与之并发且不加锁，
+// 读者须在 epoch 临界区内调用 find 并使用返回的节点
+class HashIndex {
+ public:
+  // epoch 为空时旧表立即释放，此时不能有并发的读者
+  explicit HashIndex(EpochManager* epoch);
+
+  HashIndex(const HashIndex&) = delete;
+
+  HashIndex& operator=(const HashIndex&) = delete;
+
+  ~HashIndex();
+
+  // 返回哈希为 hash 且 match(node) 为 true 的节点，找不到返回空
+  template <typename Match>
+  void* find(uint64_t hash, Match&& match) const {
+    const Table* table = table_.load(std::memory_order_acquire);
+    for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+      const Slot& slot = table->slots[i];
+      // 先以 acquire 读指针再读哈希：看到节点时也能看到写入它之前的哈希
+      void* node = slot.node.load(std::memory_order_acquire);
+      if (node == nullptr) {
+        return nullptr;
+      }
+      if (node != tombstone() &&
+          slot.hash.load(std::memory_order_relaxed) == hash && match(node)) {
+        return node;
+      }
+    }
+  }
+
+  // 调用方保证表中没有同一个键
+  void insert(uint64_t hash, void* node);
+
+  // 把 old_node 所在的槽位换成 new_node（覆盖写换了新节点）
+  void replace(uint64_t hash, void* old_node, void* new_node);
+
+  void erase(uint64_t hash, void* node);
+
+  // 预留至少 n 个键的容量
+  void reserve(size_t n);
+
+  size_t size() const { return live_; }
+
+  // 当前表占用的内存，不含等待释放的旧表
+  size_t memory_usage() const { return memory_bytes_; }
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> hash{0};
+    std::atomic<void*> node{nullptr};
+  };
+
+  struct Table {
+    explicit Table(size_t capacity) : mask(capacity - 1), slots(capacity) {}
+
+    size_t bytes() const { return sizeof(Table) + slots.size() * sizeof(Slot); }
+
+    size_t mask;
+    std::vector<Slot> slots;  // 容量为 2 的幂
+  };
+
+  static constexpr size_t kMinCapacity = 16;
+
+  static void* tombstone() {
+    static char sentinel;
+    return &sentinel;
+  }
+
+  static void free_table(void* table, void*) {
+    delete static_cast<Table*>(table);
+  }
+
+  // 写者使用：查找 node 所在的槽位
+  Slot* find_slot(uint64_t hash, const void* node) const;
+
+  // 以 capacity 个槽位重建并发布新表，丢弃墓碑
+  void rehash(size_t capacity);
+
+  EpochManager* epoch_;
+  std::atomic<Table*> table_;
+  size_t live_;  // 有效节点数，仅写者访问
+  size_t used_;  // 有效节点与墓碑之和，仅写者访问
+  size_t memory_bytes_;
+};
+
+#endif  // HASH_INDEX_H
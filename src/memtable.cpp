@@ -0,0 +1,177 @@
+//
+// Created by Koschei on 2025/2/28.
+//
+
+#include "memtable.h"
+
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
+template <typename Key, typename Value, class Comparator>
+MemTable<Key, Value, Comparator>::MemTable(Comparator cmp,
+                                           const MemTableOptions& options,
+                                           FlushCallback flush)
+    : compare_(cmp),
+      flush_threshold_(options.flush_threshold),
+      table_options_(options.table_options),
+      flush_(std::move(flush)),
+      stop_(false),
+      flushed_(0) {
+  assert(flush_);
+  table_options_.concurrent_readers = true;
+  version_ = std::make_shared<const Version>(Version{make_table(), {}});
+  flush_thread_ = std::thread(&MemTable::flush_loop, this);
+}
+
+template <typename Key, typename Value, class Comparator>
+MemTable<Key, Value, Comparator>::~MemTable() {
+  {
+    std::lock_guard<std::mutex> lock(version_mutex_);
+    stop_ = true;
+  }
+  flush_cv_.notify_all();
+  flush_thread_.join();
+}
+
+template <typename Key, typename Value, class Comparator>
+void MemTable<Key, Value, Comparator>::insert(Key key, Value value) {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  auto& active = *current()->active;
+  active.insert(std::move(key), std::optional<Value>(std::move(value)));
+  if (active.get_size() >= flush_threshold_) {
+    freeze_locked();
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+void MemTable<Key, Value, Comparator>::erase(Key key) {
+  // 更旧的表里可能还有这个键，因此总是写入删除标记
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  auto& active = *current()->active;
+  active.insert(std::move(key), std::nullopt);
+  // 只有删除的负载同样会让活跃表增长
+  if (active.get_size() >= flush_threshold_) {
+    freeze_locked();
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+std::optional<Value> MemTable<Key, Value, Comparator>::get(
+    const Key& key) const {
+  auto version = current();
+  std::optional<Value> result;
+  if (version->active->get_with(
+          key, [&](const std::optional<Value>& v) { result = v; })) {
+    return result;
+  }
+  for (auto it = version->immutables.rbegin();
+       it != version->immutables.rend(); ++it) {
+    if ((*it)->get_with(key,
+                        [&](const std::optional<Value>& v) { result = v; })) {
+      return result;
+    }
+  }
+  return std::nullopt;
+}
+
+template <typename Key, typename Value, class Comparator>
+template <typename Callback>
+void MemTable<Key, Value, Comparator>::scan(const Key& start, const Key& end,
+                                           Callback&& callback) const {
+  // 迭代期间持有版本，其中的表不会被释放
+  auto version = current();
+  std::vector<const Table*> sources = {version->active.get()};
+  for (auto it = version->immutables.rbegin();
+       it != version->immutables.rend(); ++it) {
+    sources.push_back(it->get());
+  }
+  MergingIterator<Key, std::optional<Value>, Comparator> it(std::move(sources),
+                                                            compare_);
+  for (it.seek(start); !it.is_end() && compare_(it.get_key(), end) < 0; ++it) {
+    if (!it.get_value()) {
+      continue;  // 删除标记
+    }
+    if constexpr (std::is_same_v<std::invoke_result_t<Callback, const Key&,
+                                                      const Value&>,
+                                 bool>) {
+      if (!callback(it.get_key(), *it.get_value())) {
+        return;
+      }
+    } else {
+      callback(it.get_key(), *it.get_value());
+    }
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+void MemTable<Key, Value, Comparator>::freeze() {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  freeze_locked();
+}
+
+template <typename Key, typename Value, class Comparator>
+void MemTable<Key, Value, Comparator>::freeze_locked() {
+  if (current()->active->begin().is_end()) {
+    return;
+  }
+  // 新表在加锁前创建，持有 version_mutex_ 期间只做指针拷贝。
+  // 不可变表须在锁内读取，否则可能覆盖后台线程刚做的移除
+  auto next = std::make_shared<Version>(Version{make_table(), {}});
+  {
+    std::lock_guard<std::mutex> lock(version_mutex_);
+    auto version = current();
+    next->immutables = version->immutables;
+    next->immutables.push_back(version->active);
+    std::atomic_store(&version_, std::shared_ptr<const Version>(next));
+  }
+  flush_cv_.notify_all();
+}
+
+template <typename Key, typename Value, class Comparator>
+void MemTable<Key, Value, Comparator>::flush_loop() {
+  std::unique_lock<std::mutex> lock(version_mutex_);
+  while (true) {
+    flush_cv_.wait(lock,
+                   [&] { return stop_ || !current()->immutables.empty(); });
+    if (current()->immutables.empty()) {
+      return;  // 已停止且没有待刷的表
+    }
+    // 写者只会在末尾追加，最早冻结的表始终在最前面
+    auto table = current()->immutables.front();
+    lock.unlock();
+    flush_(*table);
+    lock.lock();
+
+    auto version = current();
+    auto next = std::make_shared<Version>(Version{
+        version->active, {version->immutables.begin() + 1,
+                          version->immutables.end()}});
+    std::atomic_store(&version_, std::shared_ptr<const Version>(next));
+    ++flushed_;
+    flush_cv_.notify_all();
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+void MemTable<Key, Value, Comparator>::wait_for_flush() const {
+  std::unique_lock<std::mutex> lock(version_mutex_);
+  flush_cv_.wait(lock, [&] { return current()->immutables.empty(); });
+}
+
+template <typename Key, typename Value, class Comparator>
+size_t MemTable<Key, Value, Comparator>::get_active_size() const {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  return current()->active->get_size();
+}
+
+template <typename Key, typename Value, class Comparator>
+size_t MemTable<Key, Value, Comparator>::get_immutable_count() const {
+  return current()->immutables.size();
+}
+
+template <typename Key, typename Value, class Comparator>
+uint64_t MemTable<Key, Value, Comparator>::get_flushed_count() const {
+  std::lock_guard<std::mutex> lock(version_mutex_);
+  return flushed_;
+}
@@ -0,0 +1,116 @@
+//
+// Created by Koschei on 2025/2/28.
+//
+
+#ifndef MEMTABLE_H
+#define MEMTABLE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "merging_iterator.h"
+#include "skiplist.h"
+
+struct MemTableOptions {
+  // 活跃表的 get_size() 达到该值时冻结，换上一张新表
+  size_t flush_threshold = 4 << 20;
+  // 每张表的配置，concurrent_readers 总是开启
+  SkipListOptions table_options;
+};
+
+// LSM 的内存表：写入进入活跃表，活跃表写满后冻结为只读的不可变表，
+// 同时换上一张空表，由后台线程按冻结顺序把不可变表交给 flush 回调。
+// - 写操作（insert/erase/freeze）之间互斥，erase 写入删除标记
+// - 读操作不加锁：原子地取得当前版本（活跃表 + 不可变表）的快照，
+//   从新到旧依次查找，遇到的第一条记录（包括删除标记）即为结果。
+//   各表以单写多读模式运行，冻结与刷盘都不会阻塞读者
+template <typename Key, typename Value, class Comparator>
+class MemTable {
+ public:
+  // 表中的值为空表示该键已被删除，刷盘时需要保留删除标记
+  using Table = SkipList<Key, std::optional<Value>, Comparator>;
+  // 在后台线程中调用，返回后该表从不可变表中移除
+  using FlushCallback = std::function<void(const Table&)>;
+
+  MemTable(Comparator cmp, const MemTableOptions& options,
+           FlushCallback flush);
+
+  MemTable(const MemTable&) = delete;
+
+  MemTable& operator=(const MemTable&) = delete;
+
+  // 刷完所有已冻结的表后停止后台线程，活跃表不会被刷盘，
+  // 需要时先调用 freeze
+  ~MemTable();
+
+  void insert(Key key, Value value);
+
+  void erase(Key key);
+
+  std::optional<Value> get(const Key& key) const;
+
+  bool contains(const Key& key) const { return get(key).has_value(); }
+
+  // 按升序对 [start, end) 内未删除的每个键调用 callback(key, value)，
+  // callback 返回 bool 时，返回 false 会提前结束。
+  // 用 MergingIterator 合并当前版本的活跃表与不可变表，同一个键取最新的记录
+  template <typename Callback>
+  void scan(const Key& start, const Key& end, Callback&& callback) const;
+
+  // 立即冻结活跃表，活跃表为空时什么也不做
+  void freeze();
+
+  // 阻塞到当前所有不可变表都已刷盘
+  void wait_for_flush() const;
+
+  size_t get_active_size() const;
+
+  size_t get_immutable_count() const;
+
+  // 已刷盘的表的数量
+  uint64_t get_flushed_count() const;
+
+ private:
+  // 某一时刻的表集合，创建后不再修改，替换时整体换新
+  struct Version {
+    std::shared_ptr<Table> active;
+    std::vector<std::shared_ptr<Table>> immutables;  // 最早冻结的在前
+  };
+
+  Comparator const compare_;
+  size_t flush_threshold_;
+  SkipListOptions table_options_;
+  FlushCallback flush_;
+
+  std::shared_ptr<const Version> version_;  // 通过 std::atomic_load/store 访问
+  mutable std::mutex write_mutex_;          // 串行化写操作
+  // 保护 version_ 的替换、stop_ 和 flushed_，
+  // 与 write_mutex_ 同时持有时总是后加锁
+  mutable std::mutex version_mutex_;
+  mutable std::condition_variable flush_cv_;
+  bool stop_;
+  uint64_t flushed_;
+  std::thread flush_thread_;
+
+  std::shared_ptr<const Version> current() const {
+    return std::atomic_load(&version_);
+  }
+
+  std::shared_ptr<Table> make_table() const {
+    return std::make_shared<Table>(compare_, table_options_);
+  }
+
+  // 调用方持有 write_mutex_
+  void freeze_locked();
+
+  void flush_loop();
+};
+
+#endif  // MEMTABLE_H
@@ -0,0 +1,94 @@
+//
+// Created by Koschei on 2025/3/6.
+//
+
+#include "merging_iterator.h"
+
+#include <algorithm>
+#include <utility>
+
+template <typename Key, typename Value, class Comparator>
+MergingIterator<Key, Value, Comparator>::MergingIterator(
+    std::vector<const List*> sources, Comparator cmp)
+    : sources_(std::move(sources)),
+      cursors_(sources_.size()),
+      tree_(std::max<size_t>(sources_.size(), 1)),
+      compare_(cmp) {
+  seek_to_first();
+}
+
+template <typename Key, typename Value, class Comparator>
+bool MergingIterator<Key, Value, Comparator>::beats(size_t a, size_t b) const {
+  if (cursors_[a].is_end()) {
+    return false;
+  }
+  if (cursors_[b].is_end()) {
+    return true;
+  }
+  int r = compare_(cursors_[a].get_key(), cursors_[b].get_key());
+  return r < 0 || (r == 0 && a < b);
+}
+
+template <typename Key, typename Value, class Comparator>
+size_t MergingIterator<Key, Value, Comparator>::build(size_t node) {
+  if (node >= cursors_.size()) {
+    return node - cursors_.size();  // 叶子
+  }
+  size_t left = build(2 * node);
+  size_t right = build(2 * node + 1);
+  if (beats(left, right)) {
+    tree_[node] = right;
+    return left;
+  }
+  tree_[node] = left;
+  return right;
+}
+
+template <typename Key, typename Value, class Comparator>
+void MergingIterator<Key, Value, Comparator>::replay(size_t leaf) {
+  size_t winner = leaf;
+  for (size_t node = (leaf + cursors_.size()) / 2; node > 0; node /= 2) {
+    if (beats(tree_[node], winner)) {
+      std::swap(tree_[node], winner);
+    }
+  }
+  tree_[0] = winner;
+}
+
+template <typename Key, typename Value, class Comparator>
+MergingIterator<Key, Value, Comparator>&
+MergingIterator<Key, Value, Comparator>::operator++() {
+  size_t winner = tree_[0];
+  // 游标前进后节点仍在表中，键的引用保持有效
+  const Key& key = cursors_[winner].get_key();
+  ++cursors_[winner];
+  replay(winner);
+  // 较旧的表中的同一个键紧随其后胜出，逐个跳过
+  while (!is_end() && compare_(cursors_[tree_[0]].get_key(), key) == 0) {
+    winner = tree_[0];
+    ++cursors_[winner];
+    replay(winner);
+  }
+  return *this;
+}
+
+template <typename Key, typename Value, class Comparator>
+void MergingIterator<Key, Value, Comparator>::seek_to_first() {
+  for (size_t i = 0; i < sources_.size(); ++i) {
+    cursors_[i] = sources_[i]->begin();
+  }
+  if (!cursors_.empty()) {
+    tree_[0] = build(1);
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+template <typename K>
+void MergingIterator<Key, Value, Comparator>::seek(const K& key) {
+  for (size_t i = 0; i < sources_.size(); ++i) {
+    cursors_[i] = sources_[i]->lower_bound(key);
+  }
+  if (!cursors_.empty()) {
+    tree_[0] = build(1);
+  }
+}
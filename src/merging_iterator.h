@@ -0,0 +1,71 @@
+//
+// Created by Koschei on 2025/3/6.
+//
+
+#ifndef MERGING_ITERATOR_H
+#define MERGING_ITERATOR_H
+
+#include <cstddef>
+#include <vector>
+
+#include "skiplist.h"
+
+// 多张跳表上的有序合并视图（如活跃表与不可变表，或多个分片），
+// 按键升序给出各表的并集。sources 按从新到旧排列：同一个键出现在
+// 多张表中时只给出最新的一条（下标最小的来源），较旧的被跳过。
+// 值原样给出，MemTable 的表中空值（删除标记）同样会出现，由调用方处理。
+//
+// 用败者树做 N 路归并：tree_[0] 为当前胜者（键最小的来源），
+// 内部节点记录该处比赛的败者。前进一步只需沿胜者的叶子到根重赛一次，
+// log2(N) 次比较，少于二叉堆的下沉（每层两次比较）。
+// 与 SkipListIterator 相同，迭代期间各表不能有并发写入，除非开启了
+// concurrent_readers，此时每个游标各自持有 epoch 登记。
+// 迭代器存放表的指针，表须在迭代器的生命周期内保持存活
+template <typename Key, typename Value, class Comparator>
+class MergingIterator {
+ public:
+  using List = SkipList<Key, Value, Comparator>;
+
+  // 构造后定位到第一个键
+  MergingIterator(std::vector<const List*> sources, Comparator cmp);
+
+  const Key& get_key() const { return cursors_[tree_[0]].get_key(); }
+
+  const Value& get_value() const { return cursors_[tree_[0]].get_value(); }
+
+  // 当前键来自哪张表（sources 中的下标）
+  size_t get_source() const { return tree_[0]; }
+
+  bool is_end() const {
+    return cursors_.empty() || cursors_[tree_[0]].is_end();
+  }
+
+  // 前进到下一个不同的键
+  MergingIterator& operator++();
+
+  void seek_to_first();
+
+  // 定位到第一个 >= key 的键：每张表各做一次 O(log n) 的 lower_bound，
+  // 再以 O(N) 重建败者树，共 O(N log n)
+  template <typename K>
+  void seek(const K& key);
+
+ private:
+  // 来源 a 的当前键是否排在 b 之前：到达末尾的来源视为无穷大，
+  // 键相同时较新（下标小）的来源在前
+  bool beats(size_t a, size_t b) const;
+
+  // 自底向上建立以 node 为根的子树，返回子树的胜者
+  size_t build(size_t node);
+
+  // 来源 leaf 的游标移动后，沿叶子到根重赛
+  void replay(size_t leaf);
+
+  std::vector<const List*> sources_;
+  std::vector<typename List::Iterator> cursors_;
+  // 隐式完全二叉树：来源 i 是第 N + i 个节点，内部节点为 1 .. N - 1
+  std::vector<size_t> tree_;
+  Comparator compare_;
+};
+
+#endif  // MERGING_ITERATOR_H
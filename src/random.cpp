@@ -0,0 +1,23 @@
+//
+// Created by Koschei on 2025/2/26.
+//
+
+#include "random.h"
+
+#include <cmath>
+
+LevelGenerator::LevelGenerator(int max_level, float probability)
+    : max_level_(max_level), half_(probability == 0.5f) {
+  if (half_) {
+    return;
+  }
+  // 2^64 无法用 uint64_t 表示，p^i * 2^64 不小于 2^64 时取最大值
+  const double two_pow_64 = std::ldexp(1.0, 64);
+  double scaled = two_pow_64;
+  for (int i = 1; i < max_level; ++i) {
+    scaled *= probability;
+    thresholds_.push_back(scaled >= two_pow_64
+                              ? UINT64_MAX
+                              : static_cast<uint64_t>(scaled));
+  }
+}
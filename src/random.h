@@ -0,0 +1,56 @@
+//
+// Created by Koschei on 2025/2/26.
+//
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+#include <vector>
+
+// SplitMix64：状态只有 8 字节，任意种子（包括 0）都能产生质量不错的序列。
+// 不是线程安全的，并发使用时每个线程各持有一个
+class Random64 {
+ public:
+  explicit Random64(uint64_t seed) : state_(seed) {}
+
+  uint64_t next() {
+    uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+ private:
+  uint64_t state_;
+};
+
+// 由一次 64 位随机数直接得到节点的塔高，塔高为 k 的概率为
+// p^(k-1) * (1 - p)，并截断到 max_level：
+// - p = 0.5 时塔高为随机数末尾连续 0 的个数加一
+// - 其他概率预先计算各层的晋升阈值，随机数小于第 i 个阈值即至少晋升 i 层
+class LevelGenerator {
+ public:
+  LevelGenerator(int max_level, float probability);
+
+  int level(uint64_t random) const {
+    if (half_) {
+      // 随机数为 0 时末尾 0 的个数未定义，直接取最高层
+      int level = random == 0 ? max_level_ : __builtin_ctzll(random) + 1;
+      return level < max_level_ ? level : max_level_;
+    }
+    int level = 1;
+    while (level < max_level_ && random < thresholds_[level - 1]) {
+      ++level;
+    }
+    return level;
+  }
+
+ private:
+  int max_level_;
+  bool half_;  // p == 0.5，走末尾 0 计数的快速路径
+  // thresholds_[i] = p^(i+1) * 2^64，随 i 递减
+  std::vector<uint64_t> thresholds_;
+};
+
+#endif  // RANDOM_H
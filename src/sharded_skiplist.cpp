@@ -0,0 +1,236 @@
+//
+// Created by Koschei on 2025/2/27.
+//
+
+#include "sharded_skiplist.h"
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+#include <type_traits>
+
+template <typename Key, typename Value, class Comparator>
+ShardedSkipListIterator<Key, Value, Comparator>::ShardedSkipListIterator(
+    std::vector<ShardIterator> cursors, const Comparator* compare,
+    bool ordered)
+    : compare_(compare), ordered_(ordered) {
+  cursors.erase(std::remove_if(cursors.begin(), cursors.end(),
+                               [](const ShardIterator& it) {
+                                 return it.is_end();
+                               }),
+                cursors.end());
+  cursors_ = std::move(cursors);
+  if (ordered_) {
+    std::reverse(cursors_.begin(), cursors_.end());
+  } else {
+    std::make_heap(cursors_.begin(), cursors_.end(),
+                   [this](const ShardIterator& a, const ShardIterator& b) {
+                     return heap_less(a, b);
+                   });
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+ShardedSkipListIterator<Key, Value, Comparator>&
+ShardedSkipListIterator<Key, Value, Comparator>::operator++() {
+  if (ordered_) {
+    if ((++cursors_.back()).is_end()) {
+      cursors_.pop_back();
+    }
+    return *this;
+  }
+  auto less = [this](const ShardIterator& a, const ShardIterator& b) {
+    return heap_less(a, b);
+  };
+  std::pop_heap(cursors_.begin(), cursors_.end(), less);
+  if ((++cursors_.back()).is_end()) {
+    cursors_.pop_back();
+  } else {
+    std::push_heap(cursors_.begin(), cursors_.end(), less);
+  }
+  return *this;
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+ShardedSkipList<Key, Value, Comparator, Hash>::ShardedSkipList(
+    Comparator cmp, int num_shards, const SkipListOptions& options, Hash hash)
+    : mode_(ShardingMode::kHash),
+      concurrent_readers_(options.concurrent_readers),
+      compare_(cmp),
+      hash_(hash) {
+  init_shards(std::max(num_shards, 1), options);
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+ShardedSkipList<Key, Value, Comparator, Hash>::ShardedSkipList(
+    Comparator cmp, std::vector<Key> split_keys,
+    const SkipListOptions& options)
+    : mode_(ShardingMode::kRange),
+      concurrent_readers_(options.concurrent_readers),
+      split_keys_(std::move(split_keys)),
+      compare_(cmp),
+      hash_() {
+  for (size_t i = 1; i < split_keys_.size(); ++i) {
+    assert(compare_(split_keys_[i - 1], split_keys_[i]) < 0);
+  }
+  init_shards(split_keys_.size() + 1, options);
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+void ShardedSkipList<Key, Value, Comparator, Hash>::init_shards(
+    size_t count, const SkipListOptions& options) {
+  shards_.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    shards_.push_back(std::make_unique<ShardSlot>(compare_, options));
+  }
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+size_t ShardedSkipList<Key, Value, Comparator, Hash>::shard_index(
+    const Key& key) const {
+  if (mode_ == ShardingMode::kRange) {
+    // 第一个 > key 的分割键的下标即所在分片
+    auto it = std::upper_bound(split_keys_.begin(), split_keys_.end(), key,
+                               [this](const Key& a, const Key& b) {
+                                 return compare_(a, b) < 0;
+                               });
+    return it - split_keys_.begin();
+  }
+  // std::hash 对整数是恒等映射，先乘以 2^64 / φ 打散，再取高位
+  uint64_t h = static_cast<uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ULL;
+  return (h >> 32) % shards_.size();
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+void ShardedSkipList<Key, Value, Comparator, Hash>::insert(Key key,
+                                                           Value value) {
+  auto& slot = *shards_[shard_index(key)];
+  std::unique_lock<std::shared_mutex> lock(slot.mutex);
+  slot.list.insert(std::move(key), std::move(value));
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+void ShardedSkipList<Key, Value, Comparator, Hash>::erase(const Key& key) {
+  auto& slot = *shards_[shard_index(key)];
+  std::unique_lock<std::shared_mutex> lock(slot.mutex);
+  slot.list.erase(key);
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+std::optional<Value> ShardedSkipList<Key, Value, Comparator, Hash>::get(
+    const Key& key) const {
+  const auto& slot = *shards_[shard_index(key)];
+  auto lock = read_lock(slot);
+  return slot.list.get(key);
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+bool ShardedSkipList<Key, Value, Comparator, Hash>::contains(
+    const Key& key) const {
+  const auto& slot = *shards_[shard_index(key)];
+  auto lock = read_lock(slot);
+  return slot.list.contains(key);
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+typename ShardedSkipList<Key, Value, Comparator, Hash>::Iterator
+ShardedSkipList<Key, Value, Comparator, Hash>::begin() const {
+  std::vector<typename Iterator::ShardIterator> cursors;
+  cursors.reserve(shards_.size());
+  for (const auto& slot : shards_) {
+    cursors.push_back(slot->list.begin());
+  }
+  return Iterator(std::move(cursors), &compare_,
+                  mode_ == ShardingMode::kRange);
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+typename ShardedSkipList<Key, Value, Comparator, Hash>::Iterator
+ShardedSkipList<Key, Value, Comparator, Hash>::lower_bound(
+    const Key& key) const {
+  std::vector<typename Iterator::ShardIterator> cursors;
+  if (mode_ == ShardingMode::kRange) {
+    // 之前的分片全部 < key，之后的分片全部 >= key
+    size_t first = shard_index(key);
+    cursors.push_back(shards_[first]->list.lower_bound(key));
+    for (size_t i = first + 1; i < shards_.size(); ++i) {
+      cursors.push_back(shards_[i]->list.begin());
+    }
+    return Iterator(std::move(cursors), &compare_, true);
+  }
+  cursors.reserve(shards_.size());
+  for (const auto& slot : shards_) {
+    cursors.push_back(slot->list.lower_bound(key));
+  }
+  return Iterator(std::move(cursors), &compare_, false);
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+template <typename Callback>
+void ShardedSkipList<Key, Value, Comparator, Hash>::scan(
+    const Key& start, const Key& end, Callback&& callback) const {
+  constexpr bool kStoppable =
+      std::is_same_v<std::invoke_result_t<Callback, const Key&, const Value&>,
+                     bool>;
+  if (mode_ == ShardingMode::kRange) {
+    bool stopped = false;
+    size_t last = shard_index(end);
+    for (size_t i = shard_index(start); i <= last && !stopped; ++i) {
+      auto lock = read_lock(*shards_[i]);
+      shards_[i]->list.scan(start, end, [&](const Key& k, const Value& v) {
+        if constexpr (kStoppable) {
+          stopped = !callback(k, v);
+          return !stopped;
+        } else {
+          callback(k, v);
+        }
+      });
+    }
+    return;
+  }
+  std::vector<std::shared_lock<std::shared_mutex>> locks;
+  if (!concurrent_readers_) {
+    locks.reserve(shards_.size());
+    for (const auto& slot : shards_) {
+      locks.emplace_back(slot->mutex);
+    }
+  }
+  for (auto it = lower_bound(start);
+       !it.is_end() && compare_(it.get_key(), end) < 0; ++it) {
+    if constexpr (kStoppable) {
+      if (!callback(it.get_key(), it.get_value())) {
+        return;
+      }
+    } else {
+      callback(it.get_key(), it.get_value());
+    }
+  }
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+size_t ShardedSkipList<Key, Value, Comparator, Hash>::get_shard_size(
+    size_t shard) const {
+  // 分片的统计量由写者维护，读取时总是持有读锁
+  std::shared_lock<std::shared_mutex> lock(shards_[shard]->mutex);
+  return shards_[shard]->list.get_size();
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+size_t ShardedSkipList<Key, Value, Comparator, Hash>::get_size() const {
+  size_t size = 0;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    size += get_shard_size(i);
+  }
+  return size;
+}
+
+template <typename Key, typename Value, class Comparator, class Hash>
+size_t ShardedSkipList<Key, Value, Comparator, Hash>::get_memory_usage()
+    const {
+  size_t bytes = 0;
+  for (const auto& slot : shards_) {
+    std::shared_lock<std::shared_mutex> lock(slot->mutex);
+    bytes += slot->list.get_memory_usage();
+  }
+  return bytes;
+}
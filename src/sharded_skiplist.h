@@ -0,0 +1,179 @@
+//
+// Created by Koschei on 2025/2/27.
+//
+
+#ifndef SHARDED_SKIPLIST_H
+#define SHARDED_SKIPLIST_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+#include "skiplist.h"
+
+// 分片方式
+enum class ShardingMode {
+  kHash,   // 按键的哈希值分片，点查点写均匀分散到各分片
+  kRange,  // 按分割键划分连续区间，分片之间有序，适合范围扫描
+};
+
+// 多个分片上的有序迭代器。范围分片的各分片首尾相接，依次遍历即可；
+// 哈希分片用最小堆对各分片的游标做多路归并。
+// 与 SkipListIterator 相同，迭代期间不能有并发写入，除非开启了
+// concurrent_readers，此时每个游标各自持有 epoch 登记
+template <typename Key, typename Value, class Comparator>
+class ShardedSkipListIterator {
+ public:
+  using ShardIterator = SkipListIterator<Key, Value>;
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = std::pair<Key, Value>;
+  using difference_type = std::ptrdiff_t;
+  using reference = std::pair<const Key&, const Value&>;
+  using pointer = void;
+
+  ShardedSkipListIterator() : compare_(nullptr), ordered_(true) {}
+
+  // cursors 按分片顺序给出，已到末尾的游标会被丢弃
+  ShardedSkipListIterator(std::vector<ShardIterator> cursors,
+                          const Comparator* compare, bool ordered);
+
+  const Key& get_key() const { return current().get_key(); }
+
+  const Value& get_value() const { return current().get_value(); }
+
+  bool is_end() const { return cursors_.empty(); }
+
+  reference operator*() const { return *current(); }
+
+  ShardedSkipListIterator& operator++();
+
+  ShardedSkipListIterator operator++(int) {
+    auto old = *this;
+    ++*this;
+    return old;
+  }
+
+  bool operator==(const ShardedSkipListIterator& other) const {
+    if (is_end() || other.is_end()) {
+      return is_end() == other.is_end();
+    }
+    return current() == other.current();
+  }
+
+  bool operator!=(const ShardedSkipListIterator& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  // 有序模式下 cursors_ 逆序存放，当前游标在末尾；
+  // 归并模式下 cursors_ 是以键为序的最小堆，当前游标在堆顶
+  std::vector<ShardIterator> cursors_;
+  const Comparator* compare_;
+  bool ordered_;
+
+  const ShardIterator& current() const {
+    return ordered_ ? cursors_.back() : cursors_.front();
+  }
+
+  // 堆顶为键最小的游标
+  bool heap_less(const ShardIterator& a, const ShardIterator& b) const {
+    return (*compare_)(a.get_key(), b.get_key()) > 0;
+  }
+};
+
+// 把键分散到多个独立的 SkipList 上，每个分片有自己的读写锁，
+// 不同分片上的写入互不竞争，写吞吐随线程数扩展。
+// - 哈希分片：shard = hash(key) 打散后对分片数取模
+// - 范围分片：按升序的分割键划分，分片 i 存放 [split[i-1], split[i]) 内的键
+// 写操作持有所在分片的写锁。开启 concurrent_readers 时分片本身支持
+// 单写多读，get/contains 不加锁；否则读操作持有分片的读锁
+template <typename Key, typename Value, class Comparator,
+          class Hash = std::hash<Key>>
+class ShardedSkipList {
+ public:
+  using Shard = SkipList<Key, Value, Comparator>;
+  using Iterator = ShardedSkipListIterator<Key, Value, Comparator>;
+
+  // 哈希分片，num_shards 个分片
+  ShardedSkipList(Comparator cmp, int num_shards,
+                  const SkipListOptions& options = {}, Hash hash = Hash());
+
+  // 范围分片，split_keys 须严格升序，共 split_keys.size() + 1 个分片
+  ShardedSkipList(Comparator cmp, std::vector<Key> split_keys,
+                  const SkipListOptions& options = {});
+
+  ShardedSkipList(const ShardedSkipList&) = delete;
+
+  ShardedSkipList& operator=(const ShardedSkipList&) = delete;
+
+  void insert(Key key, Value value);
+
+  void erase(const Key& key);
+
+  std::optional<Value> get(const Key& key) const;
+
+  bool contains(const Key& key) const;
+
+  // 按键升序遍历所有分片，见 ShardedSkipListIterator
+  Iterator begin() const;
+
+  Iterator end() const { return Iterator(); }
+
+  // 第一个 >= key 的位置。范围分片只在 key 所在分片查找一次，
+  // 哈希分片需要在每个分片上各查找一次
+  Iterator lower_bound(const Key& key) const;
+
+  // 按升序对 [start, end) 内的每个条目调用 callback(key, value)，
+  // 返回 false 时提前结束。范围分片依次扫描覆盖区间的分片，
+  // 每次只持有一个分片的读锁；哈希分片持有全部分片的读锁做多路归并
+  template <typename Callback>
+  void scan(const Key& start, const Key& end, Callback&& callback) const;
+
+  // key 所在的分片下标
+  size_t shard_index(const Key& key) const;
+
+  size_t shard_count() const { return shards_.size(); }
+
+  ShardingMode mode() const { return mode_; }
+
+  // 单个分片的逻辑数据量，各分片之和等于 get_size
+  size_t get_shard_size(size_t shard) const;
+
+  size_t get_size() const;
+
+  size_t get_memory_usage() const;
+
+ private:
+  // 对齐到缓存行，避免相邻分片的锁之间伪共享
+  struct alignas(64) ShardSlot {
+    ShardSlot(Comparator cmp, const SkipListOptions& options)
+        : list(cmp, options) {}
+
+    mutable std::shared_mutex mutex;
+    Shard list;
+  };
+
+  ShardingMode mode_;
+  bool concurrent_readers_;
+  std::vector<std::unique_ptr<ShardSlot>> shards_;
+  std::vector<Key> split_keys_;  // 仅范围分片使用
+
+  Comparator const compare_;
+  Hash const hash_;
+
+  void init_shards(size_t count, const SkipListOptions& options);
+
+  // 读操作的加锁方式：单写多读模式下不加锁
+  std::shared_lock<std::shared_mutex> read_lock(const ShardSlot& slot) const {
+    if (concurrent_readers_) {
+      return {};
+    }
+    return std::shared_lock<std::shared_mutex>(slot.mutex);
+  }
+};
+
+#endif  // SHARDED_SKIPLIST_H
@@ -7,142 +7,741 @@
 #include <fmt/base.h>
 #include <fmt/format.h>
 
-#include <sstream>
+#include <algorithm>
+#include <thread>
 #include <unordered_set>
 
-// 通用版本：将 Key 转换为字符串后计算长度
-template <typename Key>
-size_t get_key_length(const Key& key) {
-  std::ostringstream oss;
-  oss << key;
-  return oss.str().size();
-}
-
-// 特化版本：若 Key 是 std::string，直接返回长度
-template <>
-size_t get_key_length<std::string>(const std::string& key) {
-  return key.size();
-}
-
 template <typename Key, typename Value, class Comparator>
 SkipList<Key, Value, Comparator>::SkipList(Comparator cmp, int max_level,
                                            float prob)
+    : SkipList(cmp, [&] {
+        SkipListOptions options;
+        options.max_level = max_level;
+        options.probability = prob;
+        return options;
+      }()) {}
+
+template <typename Key, typename Value, class Comparator>
+SkipList<Key, Value, Comparator>::SkipList(Comparator cmp,
+                                           const SkipListOptions& options)
     : size_bytes_(0),
-      max_level_(max_level),
+      memory_bytes_(0),
+      max_level_(options.max_level),
       current_level_(1),
-      probability_(prob),
-      gen_(rd_()),
-      dis_(0.0, 1.0),
+      concurrent_readers_(options.concurrent_readers),
+      prefixed_(options.inline_key_prefix && has_key_prefix_v<Key>),
+      indexed_(options.indexable),
+      span_bytes_(0),
+      arena_(options.use_arena ? std::make_unique<Arena>() : nullptr),
+      bloom_(has_key_hash<Key>::value && options.bloom_expected_keys > 0 &&
+                     options.bloom_bits_per_key > 0
+                 ? std::make_unique<BloomFilter>(options.bloom_expected_keys,
+                                                 options.bloom_bits_per_key)
+                 : nullptr),
+      rng_(options.seed ? *options.seed : std::random_device{}()),
+      level_generator_(options.max_level, options.probability),
       compare_(cmp) {
-  header_ = new SkipListNode<Key, Value>({}, {}, max_level_);
+  header_ = SkipListNode<Key, Value>::create({}, {}, max_level_, arena_.get(),
+                                             false, indexed_);
+  memory_bytes_ = node_memory(header_);
+  if (indexed_) {
+    // 空表中头节点各层的后继都是末尾之后（位置 1）
+    for (int level = 0; level < max_level_; ++level) {
+      set_span(header_, level, 1);
+    }
+    span_bytes_ = sizeof(std::atomic<uint32_t>) * max_level_;
+  }
+  if (concurrent_readers_) {
+    epoch_ = std::make_unique<EpochManager>();
+  }
+  if (has_key_hash<Key>::value && options.hash_index) {
+    index_ = std::make_unique<HashIndex>(epoch_.get());
+  }
 }
 
 template <typename Key, typename Value, class Comparator>
-int SkipList<Key, Value, Comparator>::random_level() {
-  int level = 1;
-  // 通过"抛硬币"的方式随机生成层数：
-  // - 每次有50%的概率增加一层
-  // - 确保层数分布为：第1层100%，第2层50%，第3层25%，以此类推
-  // - 层数范围限制在[1, max_level]之间，避免浪费内存
-  while (dis_(gen_) < probability_ && level < max_level_) {
-    ++level;
+template <typename Iter, typename>
+SkipList<Key, Value, Comparator>::SkipList(Comparator cmp, Iter begin,
+                                           Iter end,
+                                           const SkipListOptions& options,
+                                           const BulkLoadOptions& bulk_options)
+    : SkipList(cmp, options) {
+  if (bulk_options.check_sorted &&
+      std::adjacent_find(begin, end, [&](const auto& a, const auto& b) {
+        return compare_(a.first, b.first) >= 0;
+      }) != end) {
+    insert_batch(begin, end);
+    return;
+  }
+
+  // 把输入均分给各线程，每段生成一条独立的节点链
+  auto count = std::distance(begin, end);
+  int threads = arena_ ? 1 : std::max(1, bulk_options.threads);
+  threads = static_cast<int>(std::min<decltype(count)>(threads, count));
+  std::vector<BulkChunk> chunks(std::max(threads, 1));
+  if (threads <= 1) {
+    build_chunk(begin, end, rng_.next(), &chunks[0]);
+  } else {
+    std::vector<std::thread> workers;
+    auto chunk_begin = begin;
+    for (int t = 0; t < threads; ++t) {
+      auto chunk_end = std::next(chunk_begin, count / threads +
+                                                  (t < count % threads));
+      workers.emplace_back(&SkipList::build_chunk<Iter>, this, chunk_begin,
+                           chunk_end, rng_.next(), &chunks[t]);
+      chunk_begin = chunk_end;
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+  // 从 header 开始按顺序把各段首尾相接。跳表尚未对外可见，不需要内存屏障
+  std::vector<SkipListNode<Key, Value>*> tail(max_level_, header_);
+  int current_level = 1;
+  for (auto& chunk : chunks) {
+    for (int level = 0; level < chunk.top_level; ++level) {
+      tail[level]->relaxed_set_next(level, chunk.first[level]);
+      tail[level] = chunk.last[level];
+    }
+    current_level = std::max(current_level, chunk.top_level);
+    size_bytes_ += chunk.size_bytes;
+    memory_bytes_ += chunk.memory_bytes;
+  }
+  current_level_.store(current_level, std::memory_order_relaxed);
+  if (indexed_) {
+    rebuild_spans();
+  }
+  if (index_) {
+    // 哈希索引只能由一个线程写入，节点链接好后顺序建立
+    index_->reserve(count);
+    for (auto node = header_->next(0); node != nullptr; node = node->next(0)) {
+      index_->insert(node_hash(node), node);
+    }
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+template <typename Iter>
+void SkipList<Key, Value, Comparator>::build_chunk(Iter begin, Iter end,
+                                                   uint64_t seed,
+                                                   BulkChunk* chunk) const {
+  Random64 rng(seed);
+  chunk->first.assign(max_level_, nullptr);
+  chunk->last.assign(max_level_, nullptr);
+  for (auto it = begin; it != end; ++it) {
+    // 输入为 move_iterator 时直接移动键值
+    auto&& entry = *it;
+    int level = level_generator_.level(rng.next());
+    auto node = SkipListNode<Key, Value>::create(
+        Key(std::forward<decltype(entry)>(entry).first),
+        Value(std::forward<decltype(entry)>(entry).second), level,
+        arena_.get(), prefixed_, indexed_);
+    if (bloom_) {
+      bloom_->add(node_hash(node));  // 各构建线程并发置位，add 是线程安全的
+    }
+    for (int l = 0; l < level; ++l) {
+      if (chunk->last[l] == nullptr) {
+        chunk->first[l] = node;
+      } else {
+        chunk->last[l]->relaxed_set_next(l, node);
+      }
+      chunk->last[l] = node;
+    }
+    chunk->top_level = std::max(chunk->top_level, level);
+    chunk->size_bytes += data_size(node->key_, node->value_);
+    chunk->memory_bytes += node_memory(node);
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+void SkipList<Key, Value, Comparator>::rebuild_spans() {
+  // last[level] 为第 level 层上目前最后一个节点，last_pos 为它的位置
+  std::vector<SkipListNode<Key, Value>*> last(max_level_, header_);
+  std::vector<size_t> last_pos(max_level_, 0);
+  size_t pos = 0;
+  span_bytes_ = sizeof(std::atomic<uint32_t>) * max_level_;
+  for (auto node = header_->next(0); node != nullptr; node = node->next(0)) {
+    ++pos;
+    for (int level = 0; level < node->level_; ++level) {
+      set_span(last[level], level, static_cast<uint32_t>(pos - last_pos[level]));
+      last[level] = node;
+      last_pos[level] = pos;
+    }
+    span_bytes_ += sizeof(std::atomic<uint32_t>) * node->level_;
+  }
+  for (int level = 0; level < max_level_; ++level) {
+    set_span(last[level], level,
+             static_cast<uint32_t>(pos + 1 - last_pos[level]));
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+void SkipList<Key, Value, Comparator>::link_spans(
+    const std::vector<SkipListNode<Key, Value>*>& update,
+    SkipListNode<Key, Value>* node) {
+  // distance 为 update[level] 到新节点的步数。上一层的前驱在下一层
+  // 同样存在且不晚于下一层的前驱，沿下一层从 update[level] 走到
+  // update[level - 1] 即可累加出两者的距离，步数与查找时的横向移动相当
+  uint32_t distance = 1;
+  int level = 0;
+  for (; level < node->level_; ++level) {
+    if (level > 0) {
+      for (auto x = update[level]; x != update[level - 1];
+           x = x->next(level - 1)) {
+        distance += get_span(x, level - 1);
+      }
+    }
+    uint32_t width = get_span(update[level], level);
+    set_span(node, level, width + 1 - distance);
+    set_span(update[level], level, distance);
+  }
+  // 更高的层跨过了新节点
+  for (; level < max_level_; ++level) {
+    set_span(update[level], level, get_span(update[level], level) + 1);
   }
-  return level;
+}
+
+template <typename Key, typename Value, class Comparator>
+void SkipList<Key, Value, Comparator>::retire(SkipListNode<Key, Value>* node) {
+  epoch_->retire(node, &SkipList::free_retired, arena_.get(),
+                 node_memory(node));
 }
 
 template <typename Key, typename Value, class Comparator>
 void SkipList<Key, Value, Comparator>::insert(Key key, Value value) {
   // 保存搜索过程中经过的节点
-  std::vector<SkipListNode<Key, Value>*> update(max_level_, nullptr);
+  std::vector<SkipListNode<Key, Value>*> update(max_level_, header_);
   auto current = header_;  // 不能使用引用，引用就把 header 改了
-  for (int level = current_level_ - 1; level >= 0; --level) {
-    while (current->forward_[level] &&
-           compare_(current->forward_[level]->key_, key) < 0) {
-      current = current->forward_[level];
+  auto prefix = lookup_prefix(key);
+  int current_level = current_level_.load(std::memory_order_relaxed);
+  for (int level = current_level - 1; level >= 0; --level) {
+    auto next = current->next(level);
+    while (next && compare_node(next, key, prefix) < 0) {
+      current = next;
+      next = current->next(level);
     }
     update[level] = current;
   }
-  current = current->forward_[0];
-  if (current && compare_(current->key_, key) == 0) {
-    current->value_ = std::move(value);
-  } else {
-    int new_level = random_level();
-    if (new_level > current_level_) {
-      for (int level = current_level_; level < new_level; ++level) {
-        update[level] = header_;
+  insert_after(update, std::move(key), std::move(value));
+}
+
+template <typename Key, typename Value, class Comparator>
+template <typename Iter>
+void SkipList<Key, Value, Comparator>::insert_batch(Iter begin, Iter end) {
+  auto less = [&](const Iter& a, const Iter& b) {
+    return compare_(a->first, b->first) < 0;
+  };
+  std::vector<Iter> sorted;
+  if (std::adjacent_find(begin, end, [&](const auto& a, const auto& b) {
+        return compare_(a.first, b.first) >= 0;
+      }) != end) {
+    for (auto it = begin; it != end; ++it) {
+      sorted.push_back(it);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), less);
+    // 相同的键只保留最后一个：finger 要求批次严格升序
+    auto last = std::unique(sorted.rbegin(), sorted.rend(),
+                            [&](const Iter& a, const Iter& b) {
+                              return compare_(a->first, b->first) == 0;
+                            });
+    sorted.erase(sorted.begin(), last.base());
+  }
+
+  // 未使用过的层以 header 为前驱，对任何键都成立
+  std::vector<SkipListNode<Key, Value>*> update(max_level_, header_);
+  auto insert_one = [&](Key key, Value value) {
+    // update 中的前驱键都小于当前键。需要向前移动的层总是从第 0 层开始的
+    // 连续若干层：某层的后继仍 < key 时，它下面各层的后继也 < key。
+    // 向上找到第一层后继 >= key 的层，再从它下面一层开始向下查找
+    int top = 0;
+    auto prefix = lookup_prefix(key);
+    int current_level = current_level_.load(std::memory_order_relaxed);
+    while (top < current_level) {
+      auto next = update[top]->next(top);
+      if (!next || compare_node(next, key, prefix) >= 0) {
+        break;
+      }
+      ++top;
+    }
+    auto current = top < current_level ? update[top] : header_;
+    for (int level = top - 1; level >= 0; --level) {
+      // 上一层停下的节点与本层原来的前驱取靠后的一个
+      if (current == header_ ||
+          (update[level] != header_ &&
+           compare_(update[level]->key_, current->key_) > 0)) {
+        current = update[level];
       }
-      current_level_ = new_level;
+      auto next = current->next(level);
+      while (next && compare_node(next, key, prefix) < 0) {
+        current = next;
+        next = current->next(level);
+      }
+      update[level] = current;
+    }
+    auto node = insert_after(update, std::move(key), std::move(value));
+    // 之后的键都大于该节点，它就是各层新的前驱
+    for (int level = 0; level < node->level_; ++level) {
+      update[level] = node;
+    }
+  };
+  if (sorted.empty()) {
+    for (auto it = begin; it != end; ++it) {
+      insert_one(it->first, it->second);
+    }
+  } else {
+    for (const auto& it : sorted) {
+      insert_one(it->first, it->second);
     }
-    size_bytes_ += get_key_length(key) + get_key_length(value);
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+SkipListNode<Key, Value>* SkipList<Key, Value, Comparator>::insert_after(
+    std::vector<SkipListNode<Key, Value>*>& update, Key key, Value value) {
+  auto current = update[0]->next(0);
+  if (current && compare_(current->key_, key) == 0) {
+    size_bytes_ += SkipListSizeTraits<Value>::size(value);
+    size_bytes_ -= SkipListSizeTraits<Value>::size(current->value_);
+    memory_bytes_ -= node_memory(current);
+    if (!concurrent_readers_ && !SkipListNode<Key, Value>::kInlineValue) {
+      current->value_ = std::move(value);
+      memory_bytes_ += node_memory(current);
+      return current;
+    }
+    // 读者可能正在读取旧值，或值内联在节点中：
+    // 用同样塔高的新节点整体替换旧节点
     auto new_node =
-        new SkipListNode(std::move(key), std::move(value), max_level_);
-    for (int level = 0; level < new_level; ++level) {
-      new_node->forward_[level] = update[level]->forward_[level];
-      update[level]->forward_[level] = new_node;
+        create_node(std::move(key), std::move(value), current->level_);
+    memory_bytes_ += node_memory(new_node);
+    for (int level = 0; level < current->level_; ++level) {
+      new_node->relaxed_set_next(level, current->next(level));
+      if (indexed_) {
+        set_span(new_node, level, get_span(current, level));
+      }
+    }
+    for (int level = 0; level < current->level_; ++level) {
+      update[level]->set_next(level, new_node);
+    }
+    if (index_) {
+      index_->replace(node_hash(new_node), current, new_node);
+    }
+    if (concurrent_readers_) {
+      retire(current);
+    } else {
+      SkipListNode<Key, Value>::destroy(current, arena_.get());
     }
+    return new_node;
   }
+  int current_level = current_level_.load(std::memory_order_relaxed);
+  int new_level = random_level();
+  if (new_level > current_level) {
+    for (int level = current_level; level < new_level; ++level) {
+      update[level] = header_;
+    }
+    // 读者先看到更高的层数也没关系：这些层上 header 的后继仍为空
+    current_level_.store(new_level, std::memory_order_relaxed);
+  }
+  size_bytes_ += data_size(key, value);
+  auto new_node = create_node(std::move(key), std::move(value), new_level);
+  memory_bytes_ += node_memory(new_node);
+  uint64_t hash = bloom_ || index_ ? node_hash(new_node) : 0;
+  if (bloom_) {
+    // 先置位再发布节点：读者看到节点时也能看到过滤器中的位
+    bloom_->add(hash);
+  }
+  // 先填好新节点的后继，再自底向上用 release 写发布到各层
+  for (int level = 0; level < new_level; ++level) {
+    new_node->relaxed_set_next(level, update[level]->next(level));
+    update[level]->set_next(level, new_node);
+  }
+  if (indexed_) {
+    link_spans(update, new_node);
+    span_bytes_ += sizeof(std::atomic<uint32_t>) * new_level;
+  }
+  if (index_) {
+    index_->insert(hash, new_node);
+  }
+  return new_node;
 }
 
 template <typename Key, typename Value, class Comparator>
-void SkipList<Key, Value, Comparator>::erase(const Key& key) {
+template <typename K>
+void SkipList<Key, Value, Comparator>::erase(const K& lookup) {
+  const auto& key = lookup_key(lookup);
+  SkipListNode<Key, Value>* found;
+  if (hashed_lookup(key, &found) && found == nullptr) {
+    return;  // 确定不在表中
+  }
   // 保存搜索过程中经过的节点
   std::vector<SkipListNode<Key, Value>*> update(max_level_, nullptr);
   auto current = header_;
-  for (int level = current_level_ - 1; level >= 0; --level) {
-    while (current->forward_[level] &&
-           compare_(current->forward_[level]->key_, key) < 0) {
-      current = current->forward_[level];
+  auto prefix = lookup_prefix(key);
+  int current_level = current_level_.load(std::memory_order_relaxed);
+  for (int level = current_level - 1; level >= 0; --level) {
+    auto next = current->next(level);
+    while (next && compare_node(next, key, prefix) < 0) {
+      current = next;
+      next = current->next(level);
     }
     update[level] = current;  // 都是 < key 或 nullptr
   }
-  // auto &prev = current->forward_[0];
-  if (current->forward_[0] && compare_(current->forward_[0]->key_, key) == 0) {
-    current = current->forward_[0];  // 下一个节点可能大于等于
-    // key，等于的话就是我要找的了
-    size_bytes_ -=
-        get_key_length(current->key_) + get_key_length(current->value_);
-    for (int level = 0; level < current_level_; ++level) {
-      // 必须是需要删除的目标节点，否则会误删无关节点
-      if (update[level]->forward_[level] &&
-          compare_(update[level]->forward_[level]->key_, key) == 0) {
-        update[level]->forward_[level] = current->forward_[level];
+  current = current->next(0);  // 下一个节点可能大于等于 key，等于的话就是要找的
+  if (current && compare_(current->key_, key) == 0) {
+    size_bytes_ -= data_size(current->key_, current->value_);
+    memory_bytes_ -= node_memory(current);
+    // 目标节点只出现在它自己塔高以内的层上；
+    // 被摘除节点自身的后继指针保持不变，正停在它上面的读者仍能继续前进
+    for (int level = 0; level < current->level_; ++level) {
+      update[level]->set_next(level, current->next(level));
+    }
+    if (indexed_) {
+      // 前驱在节点自身的层上接过它的跨度，更高的层少跨过一个条目；
+      // 当前层数以上的层只有头节点
+      for (int level = 0; level < max_level_; ++level) {
+        auto prev = level < current_level ? update[level] : header_;
+        uint32_t width = get_span(prev, level) - 1;
+        if (level < current->level_) {
+          width += get_span(current, level);
+        }
+        set_span(prev, level, width);
       }
+      span_bytes_ -= sizeof(std::atomic<uint32_t>) * current->level_;
+    }
+    if (index_) {
+      index_->erase(node_hash(current), current);
+    }
+    if (concurrent_readers_) {
+      retire(current);  // 读者可能仍持有该节点，延迟释放
+    } else {
+      // 释放被删除的节点内存（Arena 模式下只析构）
+      SkipListNode<Key, Value>::destroy(current, arena_.get());
     }
-    delete current;  // 释放被删除的节点内存
     // 删除节点可能导致层级降低
-    while (current_level_ > 1 &&
-           header_->forward_[current_level_ - 1] == nullptr) {
-      --current_level_;
+    while (current_level > 1 && header_->next(current_level - 1) == nullptr) {
+      --current_level;
     }
+    current_level_.store(current_level, std::memory_order_relaxed);
   }
 }
 
 template <typename Key, typename Value, class Comparator>
-std::optional<Key> SkipList<Key, Value, Comparator>::get(const Key& key) const {
+template <typename Before>
+SkipListNode<Key, Value>* SkipList<Key, Value, Comparator>::find_first(
+    Before&& before) const {
   auto current = header_;
-  for (int level = current_level_ - 1; level >= 0; --level) {
-    while (current->forward_[level] &&
-           compare_(current->forward_[level]->key_, key) < 0) {
-      current = current->forward_[level];
+  SkipListNode<Key, Value>* next = nullptr;
+  // 每个后继指针只读一次：单写多读模式下写者可能同时修改它，
+  // 最终结果直接取第 0 层停下时读到的后继
+  for (int level = current_level_.load(std::memory_order_relaxed) - 1;
+       level >= 0; --level) {
+    next = current->next(level);
+    while (next && before(next)) {
+      current = next;
+      next = current->next(level);
     }
   }
-  current = current->forward_[0];
-  if (current && compare_(current->key_, key) == 0) {
-    return current->value_;
+  return next;
+}
+
+template <typename Key, typename Value, class Comparator>
+std::shared_ptr<EpochManager::Guard> SkipList<Key, Value, Comparator>::pin()
+    const {
+  if (epoch_) {
+    return std::make_shared<EpochManager::Guard>(epoch_->pin());
   }
-  return {};
+  return nullptr;
 }
 
 template <typename Key, typename Value, class Comparator>
-bool SkipList<Key, Value, Comparator>::contains(const Key& key) const {
-  return get(key).has_value();
+template <typename K, typename Visitor>
+bool SkipList<Key, Value, Comparator>::get_with(const K& lookup,
+                                                Visitor&& visitor) const {
+  const auto& key = lookup_key(lookup);
+  // 单写多读模式下登记 epoch，保证读取期间经过的节点不会被释放
+  std::optional<EpochManager::Guard> guard;
+  if (epoch_) {
+    guard.emplace(epoch_->pin());
+  }
+  SkipListNode<Key, Value>* node;
+  // 过滤器排除的键不访问任何节点，哈希索引直接定位到节点
+  if (!hashed_lookup(key, &node)) {
+    auto prefix = lookup_prefix(key);
+    node = find_first([&](const SkipListNode<Key, Value>* node) {
+      return compare_node(node, key, prefix) < 0;
+    });
+    if (node && compare_node(node, key, prefix) != 0) {
+      node = nullptr;
+    }
+  }
+  if (node) {
+    visitor(static_cast<const Value&>(node->value_));
+    return true;
+  }
+  return false;
+}
+
+template <typename Key, typename Value, class Comparator>
+template <typename K>
+std::optional<Value> SkipList<Key, Value, Comparator>::get(
+    const K& key) const {
+  std::optional<Value> result;
+  get_with(key, [&](const Value& value) { result.emplace(value); });
+  return result;
+}
+
+template <typename Key, typename Value, class Comparator>
+template <typename K>
+bool SkipList<Key, Value, Comparator>::contains(const K& key) const {
+  return get_with(key, [](const Value&) {});
+}
+
+template <typename Key, typename Value, class Comparator>
+template <typename K>
+size_t SkipList<Key, Value, Comparator>::rank(const K& lookup) const {
+  const auto& key = lookup_key(lookup);
+  std::optional<EpochManager::Guard> guard;
+  if (epoch_) {
+    guard.emplace(epoch_->pin());
+  }
+  auto prefix = lookup_prefix(key);
+  size_t pos = 0;
+  if (!indexed_) {
+    for (auto node = header_->next(0);
+         node && compare_node(node, key, prefix) < 0; node = node->next(0)) {
+      ++pos;
+    }
+    return pos;
+  }
+  // 与 find_first 相同的查找路径，每次横向移动累加跨度
+  auto current = header_;
+  for (int level = current_level_.load(std::memory_order_relaxed) - 1;
+       level >= 0; --level) {
+    auto next = current->next(level);
+    while (next && compare_node(next, key, prefix) < 0) {
+      pos += get_span(current, level);
+      current = next;
+      next = current->next(level);
+    }
+  }
+  return pos;
+}
+
+template <typename Key, typename Value, class Comparator>
+std::optional<std::pair<Key, Value>> SkipList<Key, Value, Comparator>::at(
+    size_t index) const {
+  auto it = seek_to_index(index);
+  if (it.is_end()) {
+    return std::nullopt;
+  }
+  return std::make_pair(it.get_key(), it.get_value());
+}
+
+template <typename Key, typename Value, class Comparator>
+typename SkipList<Key, Value, Comparator>::Iterator
+SkipList<Key, Value, Comparator>::seek_to_index(size_t index) const {
+  auto guard = pin();
+  if (!indexed_) {
+    auto node = header_->next(0);
+    for (size_t i = 0; i < index && node != nullptr; ++i) {
+      node = node->next(0);
+    }
+    return Iterator(node, std::move(guard));
+  }
+  // 头节点位置为 0，第 index 个条目位于 index + 1：
+  // 每层尽量向前走，但不越过目标位置。
+  // 与 index 比较而不是计算 index + 1，index 为 SIZE_MAX 时不会溢出
+  size_t pos = 0;
+  auto current = header_;
+  for (int level = current_level_.load(std::memory_order_relaxed) - 1;
+       level >= 0 && (pos == 0 || pos - 1 < index); --level) {
+    auto next = current->next(level);
+    while (next && pos + get_span(current, level) - 1 <= index) {
+      pos += get_span(current, level);
+      current = next;
+      next = current->next(level);
+    }
+  }
+  return Iterator(pos > 0 && pos - 1 == index ? current : nullptr,
+                  std::move(guard));
+}
+
+template <typename Key, typename Value, class Comparator>
+template <typename K>
+void SkipList<Key, Value, Comparator>::multi_get(
+    const std::vector<K>& keys,
+    std::vector<std::optional<Value>>* results) const {
+  if constexpr (!std::is_same_v<K, Key> &&
+                !is_transparent_comparator<Comparator>::value) {
+    // 查找过程中每一步都要比较，先把所有键一次性转换成 Key
+    multi_get(std::vector<Key>(keys.begin(), keys.end()), results);
+  } else {
+    results->assign(keys.size(), std::nullopt);
+    std::optional<EpochManager::Guard> guard;
+    if (epoch_) {
+      guard.emplace(epoch_->pin());
+    }
+
+    // 一个进行中的查找：在 level 层上 current->key_ < key，
+    // next 为 current 在该层的后继，已经发出预取
+    struct Search {
+      size_t index;
+      uint64_t prefix;
+      int level;
+      SkipListNode<Key, Value>* current;
+      SkipListNode<Key, Value>* next;
+    };
+    Search searches[kMultiGetWidth];
+    int top_level = current_level_.load(std::memory_order_relaxed);
+    size_t next_index = 0;
+    auto start = [&](Search* search) {
+      // 过滤器或哈希索引能直接回答的键不占用查找槽位
+      SkipListNode<Key, Value>* node;
+      while (next_index < keys.size() &&
+             hashed_lookup(keys[next_index], &node)) {
+        if (node) {
+          (*results)[next_index].emplace(node->value_);
+        }
+        ++next_index;
+      }
+      if (next_index == keys.size()) {
+        return false;
+      }
+      *search = {next_index, lookup_prefix(keys[next_index]), top_level - 1,
+                 header_, header_->next(top_level - 1)};
+      ++next_index;
+      __builtin_prefetch(search->next);
+      return true;
+    };
+
+    int active = 0;
+    while (active < kMultiGetWidth && start(&searches[active])) {
+      ++active;
+    }
+    while (active > 0) {
+      for (int i = 0; i < active;) {
+        auto& search = searches[i];
+        const auto& key = keys[search.index];
+        if (search.next &&
+            compare_node(search.next, key, search.prefix) < 0) {
+          search.current = search.next;
+        } else if (search.level > 0) {
+          --search.level;
+        } else {
+          if (search.next &&
+              compare_node(search.next, key, search.prefix) == 0) {
+            (*results)[search.index].emplace(search.next->value_);
+          }
+          // 用新的键接替完成的查找；没有剩余的键时把最后一个查找移过来
+          if (start(&search)) {
+            ++i;
+          } else {
+            search = searches[--active];
+          }
+          continue;
+        }
+        search.next = search.current->next(search.level);
+        __builtin_prefetch(search.next);
+        ++i;
+      }
+    }
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+typename SkipList<Key, Value, Comparator>::Iterator
+SkipList<Key, Value, Comparator>::begin() const {
+  auto guard = pin();
+  return Iterator(header_->next(0), std::move(guard));
+}
+
+template <typename Key, typename Value, class Comparator>
+template <typename K>
+typename SkipList<Key, Value, Comparator>::Iterator
+SkipList<Key, Value, Comparator>::lower_bound(const K& lookup) const {
+  const auto& key = lookup_key(lookup);
+  auto prefix = lookup_prefix(key);
+  auto guard = pin();
+  auto node = find_first([&](const SkipListNode<Key, Value>* node) {
+    return compare_node(node, key, prefix) < 0;
+  });
+  return Iterator(node, std::move(guard));
+}
+
+template <typename Key, typename Value, class Comparator>
+template <typename K>
+typename SkipList<Key, Value, Comparator>::Iterator
+SkipList<Key, Value, Comparator>::upper_bound(const K& lookup) const {
+  const auto& key = lookup_key(lookup);
+  auto prefix = lookup_prefix(key);
+  auto guard = pin();
+  auto node = find_first([&](const SkipListNode<Key, Value>* node) {
+    return compare_node(node, key, prefix) <= 0;
+  });
+  return Iterator(node, std::move(guard));
+}
+
+template <typename Key, typename Value, class Comparator>
+template <typename Callback>
+void SkipList<Key, Value, Comparator>::scan(const Key& start, const Key& end,
+                                            Callback&& callback) const {
+  for (auto it = lower_bound(start);
+       !it.is_end() && compare_(it.get_key(), end) < 0; ++it) {
+    if constexpr (std::is_same_v<std::invoke_result_t<Callback, const Key&,
+                                                      const Value&>,
+                                 bool>) {
+      if (!callback(it.get_key(), it.get_value())) {
+        return;
+      }
+    } else {
+      callback(it.get_key(), it.get_value());
+    }
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+typename SkipList<Key, Value, Comparator>::Iterator
+SkipList<Key, Value, Comparator>::begin_preffix(const Key& prefix) const {
+  // 带前缀的键都 >= prefix，第一个 >= prefix 的位置就是区间起点；
+  // 若该位置的键不带前缀，则它同时也是 end_preffix，区间为空
+  return lower_bound(prefix);
+}
+
+template <typename Key, typename Value, class Comparator>
+typename SkipList<Key, Value, Comparator>::Iterator
+SkipList<Key, Value, Comparator>::end_preffix(const Key& prefix) const {
+  auto guard = pin();
+  auto node = find_first([&](const SkipListNode<Key, Value>* node) {
+    return compare_(node->key_, prefix) < 0 ||
+           node->key_.compare(0, prefix.size(), prefix) == 0;
+  });
+  return Iterator(node, std::move(guard));
+}
+
+template <typename Key, typename Value, class Comparator>
+template <typename Predicate>
+std::optional<std::pair<typename SkipList<Key, Value, Comparator>::Iterator,
+                        typename SkipList<Key, Value, Comparator>::Iterator>>
+SkipList<Key, Value, Comparator>::iters_monotony_predicate(
+    Predicate&& predicate) const {
+  auto guard = pin();
+  auto begin = find_first([&](const SkipListNode<Key, Value>* node) {
+    return predicate(node->key_) > 0;
+  });
+  auto end = find_first([&](const SkipListNode<Key, Value>* node) {
+    return predicate(node->key_) >= 0;
+  });
+  if (begin == end) {
+    return std::nullopt;
+  }
+  return std::make_pair(Iterator(begin, guard), Iterator(end, guard));
 }
 
 template <typename Key, typename Value, class Comparator>
 void SkipList<Key, Value, Comparator>::print() const {
   // 获取底层所有节点并计算最大键长
   std::vector<SkipListNode<Key, Value>*> nodes;
-  auto current = header_->forward_[0];
+  auto current = header_->next(0);
   size_t max_key_length = 0;
   while (current != nullptr) {
     nodes.emplace_back(current);
@@ -151,7 +750,7 @@ void SkipList<Key, Value, Comparator>::print() const {
     if (length > max_key_length) {
       max_key_length = length;
     }
-    current = current->forward_[0];
+    current = current->next(0);
   }
 
   if (nodes.empty()) {
@@ -163,17 +762,18 @@ void SkipList<Key, Value, Comparator>::print() const {
       static_cast<int>(max_key_length) + 4;  // 键宽 + 箭头宽度
 
   // 预计算每层的节点
-  std::vector<std::unordered_set<Key> > level_keys(current_level_);
-  for (int level = 0; level < current_level_; ++level) {
-    auto node = header_->forward_[level];
+  int current_level = current_level_.load(std::memory_order_relaxed);
+  std::vector<std::unordered_set<Key> > level_keys(current_level);
+  for (int level = 0; level < current_level; ++level) {
+    auto node = header_->next(level);
     while (node != nullptr) {
       level_keys[level].emplace(node->key_);
-      node = node->forward_[level];
+      node = node->next(level);
     }
   }
 
   // 打印每一层
-  for (int level = current_level_ - 1; level >= 0; --level) {
+  for (int level = current_level - 1; level >= 0; --level) {
     fmt::print("Level{:2}: ", level);
 
     fmt::memory_buffer buffer;
@@ -7,69 +7,761 @@
 
 #include <fmt/format.h>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <memory_resource>
+#include <new>
 #include <optional>
 #include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#include "arena.h"
+#include "bloom_filter.h"
+#include "epoch.h"
+#include "hash_index.h"
+#include "random.h"
+
+// 通用版本：将 Key 转换为字符串后计算长度，仅供 print 计算显示宽度
+template <typename Key>
+size_t get_key_length(const Key& key) {
+  std::ostringstream oss;
+  oss << key;
+  return oss.str().size();
+}
+
+// 特化版本：若 Key 是 std::string，直接返回长度
+template <>
+inline size_t get_key_length<std::string>(const std::string& key) {
+  return key.size();
+}
+
+// 键值的大小统计策略，可针对自定义类型特化：
+// - size：逻辑数据量，累计到 get_size()
+// - heap_size：对象本身之外额外占用的堆内存，累计到 get_memory_usage()
+// 默认按 sizeof 计算，没有额外的堆内存
+template <typename T, typename = void>
+struct SkipListSizeTraits {
+  static size_t size(const T&) { return sizeof(T); }
+
+  static size_t heap_size(const T&) { return 0; }
+};
+
+template <typename T, typename = void>
+struct has_capacity : std::false_type {};
+
+template <typename T>
+struct has_capacity<
+    T, std::void_t<decltype(std::declval<const T&>().capacity())>>
+    : std::true_type {};
+
+// 带 size() 的容器（std::string、std::vector 等）按元素个数计算
+template <typename T>
+struct SkipListSizeTraits<
+    T, std::void_t<decltype(std::declval<const T&>().size()),
+                   typename T::value_type>> {
+  using Element = typename T::value_type;
+
+  static size_t size(const T& v) { return v.size() * sizeof(Element); }
+
+  static size_t heap_size(const T& v) {
+    if constexpr (has_capacity<T>::value) {
+      // 短字符串优化时数据存放在对象内部：
+      // 容量不超过空对象的容量说明没有分配堆内存
+      static const size_t inline_capacity = T().capacity();
+      return v.capacity() > inline_capacity ? v.capacity() * sizeof(Element)
+                                            : 0;
+    } else {
+      return size(v);
+    }
+  }
+};
+
+// std::optional 按所含的值统计，空值（如 MemTable 的删除标记）不计入
+template <typename T>
+struct SkipListSizeTraits<std::optional<T>> {
+  static size_t size(const std::optional<T>& v) {
+    return v ? SkipListSizeTraits<T>::size(*v) : 0;
+  }
+
+  static size_t heap_size(const std::optional<T>& v) {
+    return v ? SkipListSizeTraits<T>::heap_size(*v) : 0;
+  }
+};
+
+// 比较器声明了 is_transparent 时视为透明比较器（与 std::less<> 的约定一致），
+// 查找接口直接用调用方传入的类型（如 std::string_view）与 Key 比较
+template <typename Comparator, typename = void>
+struct is_transparent_comparator : std::false_type {};
+
+template <typename Comparator>
+struct is_transparent_comparator<
+    Comparator, std::void_t<typename Comparator::is_transparent>>
+    : std::true_type {};
+
+// 把键的前 8 个字节按大端序装入整数，不足 8 字节时补 0。
+// 整数的大小顺序与按字节比较的顺序一致：两个键的前缀不同，
+// 前缀的大小就决定了键的先后；前缀相同时才需要比较完整的键
+inline uint64_t make_key_prefix(std::string_view key) {
+  if (key.size() >= sizeof(uint64_t)) {
+    uint64_t prefix;
+    std::memcpy(&prefix, key.data(), sizeof(prefix));
+    return __builtin_bswap64(prefix);
+  }
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < key.size(); ++i) {
+    prefix |= static_cast<uint64_t>(static_cast<uint8_t>(key[i]))
+              << (56 - 8 * i);
+  }
+  return prefix;
+}
+
+// 能视为字节串、可以计算内联前缀的键类型
+template <typename K>
+inline constexpr bool has_key_prefix_v =
+    std::is_convertible_v<const K&, std::string_view>;
+
+// 布隆过滤器和哈希索引使用的键哈希，可针对自定义类型特化（提供 static hash）。
+// 须与比较器一致：比较为相等的键哈希值相同。可视为 std::string_view 的键
+// 按字节哈希，std::string 键用 std::string_view 查找时哈希相同；
+// 其他类型使用 std::hash，都没有时该键类型不支持布隆过滤器和哈希索引
+template <typename T, typename = void>
+struct SkipListKeyHash {};
+
+// std::hash 对整数是恒等映射，用 SplitMix64 的终结函数打散
+inline uint64_t mix_key_hash(uint64_t h) {
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+  return h ^ (h >> 31);
+}
+
+template <typename T>
+struct SkipListKeyHash<T, std::enable_if_t<has_key_prefix_v<T>>> {
+  static uint64_t hash(std::string_view key) {
+    return mix_key_hash(std::hash<std::string_view>{}(key));
+  }
+};
+
+template <typename T>
+struct SkipListKeyHash<
+    T, std::enable_if_t<!has_key_prefix_v<T> &&
+                        std::is_default_constructible_v<std::hash<T>>>> {
+  static uint64_t hash(const T& key) { return mix_key_hash(std::hash<T>{}(key)); }
+};
+
+template <typename T, typename = void>
+struct has_key_hash : std::false_type {};
+
+template <typename T>
+struct has_key_hash<T, std::void_t<decltype(SkipListKeyHash<T>::hash(
+                           std::declval<const T&>()))>> : std::true_type {};
+
+// 键或值为 std::string_view 时按字节串内联存储：插入时把字节复制到节点
+// 分配的尾部（塔和键前缀之后），key_/value_ 指向节点内的这份副本，
+// 每个条目只有一次分配。取到的 string_view 在条目被覆盖或删除前有效
 template <typename Key, typename Value>
 struct SkipListNode {
-  Key key_;                             // 节点存储的键
-  Value value_;                         // 节点存储的值
-  std::vector<SkipListNode*> forward_;  // 多层前向指针
-
-  SkipListNode(Key key, Value value, int level)
-      : key_(std::move(key)),
-        value_(std::move(value)),
-        forward_(level, nullptr) {}
+  // 覆盖写时值不能原地替换，需要换成新节点
+  static constexpr bool kInlineValue = std::is_same_v<Value, std::string_view>;
+
+  Key key_;                                // 节点存储的键
+  Value value_;                            // 节点存储的值
+  int level_;                              // 塔高，即 forward_ 的实际长度
+  std::atomic<SkipListNode*> forward_[1];  // 多层前向指针，按塔高在尾部分配
+
+  // 节点与塔在同一次分配中创建：sizeof(SkipListNode) 已包含 forward_[0]，
+  // 其余 level - 1 个指针紧跟在结构体之后。arena 非空时从 arena 中分配。
+  // with_prefix 为 true 时在塔之后再放一个 8 字节的键前缀，
+  // with_span 为 true 时再放每层一个 4 字节的跨度
+  static SkipListNode* create(Key key, Value value, int level,
+                              Arena* arena = nullptr, bool with_prefix = false,
+                              bool with_span = false) {
+    size_t size = alloc_size(level, with_prefix, with_span) +
+                  inline_size(key) + inline_size(value);
+    void* mem = arena != nullptr
+                    ? arena->allocate_aligned(size, alignof(SkipListNode))
+                    : ::operator new(size);
+    auto node = new (mem)
+        SkipListNode(std::move(key), std::move(value), level, arena);
+    if (with_span) {
+      for (int i = 0; i < level; ++i) {
+        new (&node->spans(with_prefix)[i]) std::atomic<uint32_t>(0);
+      }
+    }
+    char* bytes =
+        static_cast<char*>(mem) + alloc_size(level, with_prefix, with_span);
+    copy_inline(&node->key_, &bytes);
+    copy_inline(&node->value_, &bytes);
+    if constexpr (has_key_prefix_v<Key>) {
+      if (with_prefix) {
+        node->set_prefix(make_key_prefix(node->key_));
+      }
+    }
+    return node;
+  }
+
+  // arena 中的节点只析构不释放，内存随 arena 整体归还
+  static void destroy(SkipListNode* node, Arena* arena = nullptr) {
+    node->~SkipListNode();
+    if (arena == nullptr) {
+      ::operator delete(node);
+    }
+  }
+
+  static size_t alloc_size(int level, bool with_prefix = false,
+                           bool with_span = false) {
+    return sizeof(SkipListNode) +
+           sizeof(std::atomic<SkipListNode*>) * (level - 1) +
+           (with_prefix ? sizeof(uint64_t) : 0) +
+           (with_span ? sizeof(std::atomic<uint32_t>) * level : 0);
+  }
+
+  // 紧跟在塔之后的键前缀，仅对以 with_prefix 创建的节点有效。
+  // 该处的存储不是 uint64_t 对象，经 memcpy 读写以免违反严格别名规则
+  uint64_t prefix() const {
+    uint64_t prefix;
+    std::memcpy(&prefix, reinterpret_cast<const char*>(forward_ + level_),
+                sizeof(prefix));
+    return prefix;
+  }
+
+  void set_prefix(uint64_t prefix) {
+    std::memcpy(reinterpret_cast<char*>(forward_ + level_), &prefix,
+                sizeof(prefix));
+  }
+
+  // 各层的跨度，在塔和键前缀（with_prefix 与创建时一致）之后，
+  // 仅对以 with_span 创建的节点有效
+  std::atomic<uint32_t>* spans(bool with_prefix) {
+    return reinterpret_cast<std::atomic<uint32_t>*>(
+        reinterpret_cast<char*>(forward_ + level_) +
+        (with_prefix ? sizeof(uint64_t) : 0));
+  }
+
+  // 读者使用 acquire 读，保证能看到后继节点完整初始化后的内容
+  SkipListNode* next(int level) const {
+    return forward_[level].load(std::memory_order_acquire);
+  }
+
+  // 写者使用 release 写发布节点，此前对节点的初始化对读者可见
+  void set_next(int level, SkipListNode* node) {
+    forward_[level].store(node, std::memory_order_release);
+  }
+
+  // 节点尚未发布时使用，不需要内存屏障
+  void relaxed_set_next(int level, SkipListNode* node) {
+    forward_[level].store(node, std::memory_order_relaxed);
+  }
+
+ private:
+  SkipListNode(Key key, Value value, int level, Arena* arena)
+      : key_(construct_in(std::move(key), arena)),
+        value_(construct_in(std::move(value), arena)),
+        level_(level) {
+    for (int i = 0; i < level; ++i) {
+      new (&forward_[i]) std::atomic<SkipListNode*>(nullptr);
+    }
+  }
+
+  template <typename T>
+  static size_t inline_size(const T& v) {
+    if constexpr (std::is_same_v<T, std::string_view>) {
+      return v.size();
+    } else {
+      return 0;
+    }
+  }
+
+  // 把 string_view 指向的字节复制到 *bytes 处并改为指向副本
+  template <typename T>
+  static void copy_inline(T* v, char** bytes) {
+    if constexpr (std::is_same_v<T, std::string_view>) {
+      if (!v->empty()) {
+        std::memcpy(*bytes, v->data(), v->size());
+      }
+      *v = std::string_view(*bytes, v->size());
+      *bytes += v->size();
+    }
+  }
+
+  // 若 T 支持 pmr 分配器（如 std::pmr::string），让它的数据也落在 arena 中
+  template <typename T>
+  static T construct_in(T&& v, Arena* arena) {
+    if constexpr (std::uses_allocator_v<
+                      T, std::pmr::polymorphic_allocator<std::byte>>) {
+      if (arena != nullptr) {
+        return T(std::move(v), typename T::allocator_type(arena));
+      }
+    }
+    return std::move(v);
+  }
+};
+
+// 跳表的可选配置
+struct SkipListOptions {
+  int max_level = 16;       // 最大层数
+  float probability = 0.5;  // 每层晋升的概率
+  // 节点（以及 pmr 类型键值的数据）从 Arena 中顺序分配，
+  // erase 不归还内存，跳表析构时整体释放
+  bool use_arena = false;
+  // 单写多读模式：允许一个写线程与任意多个读线程（get/contains）并发，
+  // 读者不加锁。erase 和覆盖写摘除的旧节点交给 EpochManager，
+  // 等到没有读者能看到时再释放
+  bool concurrent_readers = false;
+  // 塔高随机数的种子，未设置时取自 std::random_device。
+  // 固定种子时同样的操作序列得到同样的跳表结构，便于复现
+  std::optional<uint64_t> seed;
+  // 在每个节点的塔之后内联存放键的前 8 个字节（大端序），查找时先比较
+  // 前缀整数，相同时才调用比较器，省去读取键的堆内存。要求 Key 可视为
+  // std::string_view，且 Comparator 的顺序与按字节比较一致；
+  // 其他键类型忽略此选项
+  bool inline_key_prefix = false;
+  // 为 insert 过的键维护一个分块布隆过滤器，get/contains/multi_get/erase
+  // 先查过滤器，确定不存在时直接返回，不访问任何节点。
+  // bloom_expected_keys 为预计的键数（0 表示关闭），与 bloom_bits_per_key
+  // 一起决定过滤器的内存；误判率由每键位数决定，可用
+  // BloomFilter::bits_per_key_for 由目标误判率换算。
+  // erase 不会清除过滤器中的位，键不支持 SkipListKeyHash 时忽略此选项
+  size_t bloom_expected_keys = 0;
+  double bloom_bits_per_key = 10;
+  // 另外维护一个键 -> 节点的开放寻址哈希表（HashIndex），insert/erase
+  // 同步更新，get/contains/get_with/multi_get 一次哈希探测即可定位节点，
+  // 不再自顶向下逐层查找；扫描和 lower_bound 等仍走跳表的各层。
+  // 每个槽位 16 字节，负载在 3/8~3/4 之间，每个键额外占用约 21~43 字节，
+  // 计入 get_memory_usage（不计入 get_size 的逻辑数据量）。
+  // 键不支持 SkipListKeyHash 时忽略此选项
+  bool hash_index = false;
+  // 可索引跳表：每个节点在各层记录到该层后继之间隔着的条目数（跨度），
+  // insert/erase 时沿途更新，rank/at/seek_to_index 按位置查找只需
+  // O(log n)，不必沿第 0 层逐个数过去。每个节点每层多占 4 字节，
+  // 计入 get_memory_usage，单独的数量见 get_span_memory_usage。
+  // 条目数不能超过 2^32 - 2
+  bool indexable = false;
+};
+
+// 批量构建的可选配置
+struct BulkLoadOptions {
+  // 构建前检查输入是否按键严格升序（n - 1 次比较），
+  // 不满足时退化为 insert_batch。关闭后输入必须保证有序且无重复
+  bool check_sorted = true;
+  // 并行创建节点和塔的线程数。Arena 模式下 Arena 不是线程安全的，
+  // 总是单线程构建
+  int threads = 1;
+};
+
+// 跳表的前向迭代器，沿第 0 层按键升序遍历。
+// 单写多读模式下迭代器（及其副本）共同持有一个 epoch 登记，
+// 存活期间经过的节点即使被写者摘除也不会被释放
+template <typename Key, typename Value>
+class SkipListIterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = std::pair<Key, Value>;
+  using difference_type = std::ptrdiff_t;
+  using reference = std::pair<const Key&, const Value&>;
+  using pointer = void;
+
+  SkipListIterator() : node_(nullptr) {}
+
+  explicit SkipListIterator(SkipListNode<Key, Value>* node,
+                            std::shared_ptr<EpochManager::Guard> guard = {})
+      : node_(node), guard_(std::move(guard)) {}
+
+  const Key& get_key() const { return node_->key_; }
+
+  const Value& get_value() const { return node_->value_; }
+
+  bool is_end() const { return node_ == nullptr; }
+
+  reference operator*() const { return {node_->key_, node_->value_}; }
+
+  SkipListIterator& operator++() {
+    node_ = node_->next(0);
+    return *this;
+  }
+
+  SkipListIterator operator++(int) {
+    auto old = *this;
+    ++*this;
+    return old;
+  }
+
+  bool operator==(const SkipListIterator& other) const {
+    return node_ == other.node_;
+  }
+
+  bool operator!=(const SkipListIterator& other) const {
+    return node_ != other.node_;
+  }
+
+ private:
+  SkipListNode<Key, Value>* node_;  // 为空表示 end
+  std::shared_ptr<EpochManager::Guard> guard_;
 };
 
 template <typename Key, typename Value, class Comparator>
 class SkipList {
  public:
+  using Iterator = SkipListIterator<Key, Value>;
+
   explicit SkipList(Comparator cmp, int max_level = 16, float prob = 0.5);
 
+  SkipList(Comparator cmp, const SkipListOptions& options);
+
+  // 由按键升序的 (key, value) 序列一次性构建跳表：单遍创建节点，
+  // 逐层把节点接到该层的尾部，除可选的有序性检查外不做任何比较，O(n)。
+  // 塔高与逐个 insert 一样随机抽取，之后的插入不受影响
+  template <typename Iter,
+            typename = typename std::iterator_traits<Iter>::iterator_category>
+  SkipList(Comparator cmp, Iter begin, Iter end,
+           const SkipListOptions& options = {},
+           const BulkLoadOptions& bulk_options = {});
+
   SkipList(const SkipList&) = delete;
 
   SkipList& operator=(const SkipList&) = delete;
 
   ~SkipList() {
-    auto current = header_->forward_[0];
+    epoch_.reset();  // 先释放退休节点，此时不应再有读者
+    auto current = header_->next(0);
     while (current != nullptr) {
-      auto next = current->forward_[0];
-      delete current;
+      auto next = current->next(0);
+      SkipListNode<Key, Value>::destroy(current, arena_.get());
       current = next;
     }
-    delete header_;
+    SkipListNode<Key, Value>::destroy(header_, arena_.get());
   }
 
   void insert(Key key, Value value);
 
-  void erase(const Key& key);
+  // 批量写入 [begin, end) 中的 (key, value) 对，元素需有 first/second 成员。
+  // 批次未严格升序时先按键稳定排序，同一个键保留最后一次写入。
+  // 相邻两次插入复用上一次的各层前驱作为 finger，下一个键只需从
+  // 必要的层开始向前查找，键聚集时每个键接近 O(1)
+  template <typename Iter>
+  void insert_batch(Iter begin, Iter end);
+
+  // 以下查找接口接受任意可与 Key 比较的类型 K：透明比较器直接用 K 比较，
+  // 不构造临时 Key；否则先转换成 Key，每次调用只转换一次
+  template <typename K>
+  void erase(const K& key);
+
+  // 返回值的副本
+  template <typename K>
+  std::optional<Value> get(const K& key) const;
+
+  // 零拷贝查找：找到时以 const Value& 调用 visitor 并返回 true。
+  // 值的引用只在 visitor 内有效，单写多读模式下调用期间持有 epoch
+  template <typename K, typename Visitor>
+  bool get_with(const K& key, Visitor&& visitor) const;
+
+  template <typename K>
+  bool contains(const K& key) const;
+
+  // 批量查找，(*results)[i] 为 keys[i] 对应值的副本。
+  // 同时推进最多 kMultiGetWidth 个查找（AMAC）：每个查找前进一步后
+  // 预取下一个要访问的节点并切换到下一个查找，多个缓存缺失相互重叠
+  template <typename K>
+  void multi_get(const std::vector<K>& keys,
+                 std::vector<std::optional<Value>>* results) const;
+
+  Iterator begin() const;
+
+  Iterator end() const { return Iterator(); }
+
+  // 定位到第一个 >= key 的位置，与 lower_bound 相同
+  template <typename K>
+  Iterator seek(const K& key) const {
+    return lower_bound(key);
+  }
+
+  // 第一个 >= key 的位置
+  template <typename K>
+  Iterator lower_bound(const K& key) const;
+
+  // 第一个 > key 的位置
+  template <typename K>
+  Iterator upper_bound(const K& key) const;
+
+  // 按升序对 [start, end) 内的每个条目调用 callback(key, value)，
+  // callback 返回 bool 时，返回 false 会提前结束扫描。
+  // 起点通过一次自顶向下的查找定位，代价为 O(log n + k)
+  template <typename Callback>
+  void scan(const Key& start, const Key& end, Callback&& callback) const;
 
-  std::optional<Key> get(const Key& key) const;
+  // 以 prefix 为前缀的键构成的区间 [begin_preffix, end_preffix)，
+  // 两端各做一次 O(log n) 的查找。要求 Key 为字符串类型，
+  // 且 Comparator 的顺序与字典序一致
+  Iterator begin_preffix(const Key& prefix) const;
 
-  bool contains(const Key& key) const;
+  Iterator end_preffix(const Key& prefix) const;
 
+  // 按单调谓词定位区间：predicate(key) 返回 1 表示 key 在区间之前，
+  // 0 表示在区间内，-1 表示在区间之后。两端各做一次 O(log n) 的查找，
+  // 返回 [begin, end)，区间为空时返回 std::nullopt
+  template <typename Predicate>
+  std::optional<std::pair<Iterator, Iterator>> iters_monotony_predicate(
+      Predicate&& predicate) const;
+
+  // 以下按位置访问的接口在开启 indexable 时为 O(log n)，
+  // 否则沿第 0 层线性计数，为 O(n)。单写多读模式下与写入并发时，
+  // 得到的位置可能偏差正在进行的写入数
+
+  // 小于 key 的条目数，即 lower_bound(key) 的下标（从 0 开始）
+  template <typename K>
+  size_t rank(const K& key) const;
+
+  // 第 index 个条目（从 0 开始）的键值副本，越界时返回 std::nullopt
+  std::optional<std::pair<Key, Value>> at(size_t index) const;
+
+  // 定位到第 index 个条目，越界时返回 end()。
+  // 分页读取 [i, i + k) 时定位一次后前进 k 步即可
+  Iterator seek_to_index(size_t index) const;
+
+  // 键值的逻辑数据量，按 SkipListSizeTraits::size 累计
   size_t get_size() const { return size_bytes_; }
 
+  // 跳表实际占用的内存：节点与塔（含头节点）、键值额外占用的堆内存，
+  // 以及布隆过滤器和哈希索引。
+  // 不含 Arena 的未用空间和等待释放的退休节点，二者分别见
+  // get_arena_usage 和 get_retired_size
+  size_t get_memory_usage() const {
+    return memory_bytes_ + get_filter_memory_usage() + get_index_memory_usage();
+  }
+
+  // 布隆过滤器占用的内存（已计入 get_memory_usage），未开启时为 0
+  size_t get_filter_memory_usage() const {
+    return bloom_ ? bloom_->memory_usage() : 0;
+  }
+
+  // 跨度占用的内存（已计入 get_memory_usage），未开启 indexable 时为 0
+  size_t get_span_memory_usage() const { return span_bytes_; }
+
+  // 哈希索引占用的内存（已计入 get_memory_usage），未开启时为 0
+  size_t get_index_memory_usage() const {
+    return index_ ? index_->memory_usage() : 0;
+  }
+
+  // Arena 模式下 Arena 实际占用的内存，堆模式下为 0
+  size_t get_arena_usage() const {
+    return arena_ ? arena_->memory_usage() : 0;
+  }
+
+  // 单写多读模式下已摘除、尚未释放的节点占用的内存
+  size_t get_retired_size() const {
+    return epoch_ ? epoch_->retired_bytes() : 0;
+  }
+
+  size_t get_peak_retired_size() const {
+    return epoch_ ? epoch_->peak_retired_bytes() : 0;
+  }
+
   void print() const;
 
  private:
+  static constexpr int kMultiGetWidth = 16;
+
   size_t size_bytes_;
+  size_t memory_bytes_;
   int max_level_;
-  int current_level_;
-  float probability_;
+  std::atomic<int> current_level_;  // 读者并发读取，写者独占修改
+  bool concurrent_readers_;
+  bool prefixed_;  // 节点带内联键前缀
+  bool indexed_;   // 节点带各层跨度
+  size_t span_bytes_;
+  std::unique_ptr<Arena> arena_;  // 为空表示节点直接走 new/delete
+  std::unique_ptr<BloomFilter> bloom_;  // 为空表示未开启过滤器
+  std::unique_ptr<HashIndex> index_;   // 为空表示未开启哈希索引
   SkipListNode<Key, Value>* header_;
-  std::random_device rd_;
-  std::mt19937 gen_;
-  std::uniform_real_distribution<> dis_;
+  // 单写多读模式下负责延迟释放被摘除的节点，须在 arena_ 之后声明
+  std::unique_ptr<EpochManager> epoch_;
+  Random64 rng_;
+  LevelGenerator level_generator_;
 
   Comparator const compare_;
 
-  int random_level();
+  int random_level() { return level_generator_.level(rng_.next()); }
+
+  // 批量构建时一段连续输入生成的节点链：各层的首尾节点，
+  // 由构建线程各自生成，最后按顺序首尾相接
+  struct BulkChunk {
+    std::vector<SkipListNode<Key, Value>*> first;
+    std::vector<SkipListNode<Key, Value>*> last;
+    int top_level = 0;
+    size_t size_bytes = 0;
+    size_t memory_bytes = 0;
+  };
+
+  template <typename Iter>
+  void build_chunk(Iter begin, Iter end, uint64_t seed,
+                   BulkChunk* chunk) const;
+
+  // update[level] 为 key 在各层的前驱，在其后插入新节点或覆盖已有节点，
+  // 返回 key 所在的节点
+  SkipListNode<Key, Value>* insert_after(
+      std::vector<SkipListNode<Key, Value>*>& update, Key key, Value value);
+
+  static size_t data_size(const Key& key, const Value& value) {
+    return SkipListSizeTraits<Key>::size(key) +
+           SkipListSizeTraits<Value>::size(value);
+  }
+
+  // 节点连同键值额外堆内存的总占用
+  size_t node_memory(const SkipListNode<Key, Value>* node) const {
+    return SkipListNode<Key, Value>::alloc_size(
+               node->level_, prefixed_ && node != header_, indexed_) +
+           SkipListSizeTraits<Key>::heap_size(node->key_) +
+           SkipListSizeTraits<Value>::heap_size(node->value_);
+  }
+
+  SkipListNode<Key, Value>* create_node(Key key, Value value, int level) {
+    return SkipListNode<Key, Value>::create(std::move(key), std::move(value),
+                                            level, arena_.get(), prefixed_,
+                                            indexed_);
+  }
+
+  // node 在 level 层的跨度：从 node 沿第 0 层走到它在该层的后继的步数。
+  // 后继为空时视为走到末尾之后的位置（条目数 + 1），头节点的位置为 0
+  std::atomic<uint32_t>& span(const SkipListNode<Key, Value>* node,
+                              int level) const {
+    return const_cast<SkipListNode<Key, Value>*>(node)->spans(
+        prefixed_ && node != header_)[level];
+  }
+
+  uint32_t get_span(const SkipListNode<Key, Value>* node, int level) const {
+    return span(node, level).load(std::memory_order_relaxed);
+  }
+
+  void set_span(SkipListNode<Key, Value>* node, int level, uint32_t width) {
+    span(node, level).store(width, std::memory_order_relaxed);
+  }
+
+  // 新节点 node 已链接到 update 之后，更新 node 与各层前驱的跨度
+  void link_spans(const std::vector<SkipListNode<Key, Value>*>& update,
+                  SkipListNode<Key, Value>* node);
+
+  // 从第 0 层顺序地重新计算所有节点的跨度，用于批量构建
+  void rebuild_spans();
+
+  // 查找键的前缀；不使用前缀时为 0，不参与比较
+  template <typename K>
+  uint64_t lookup_prefix(const K& key) const {
+    if constexpr (has_key_prefix_v<K>) {
+      if (prefixed_) {
+        return make_key_prefix(key);
+      }
+    }
+    return 0;
+  }
+
+  // 查找键与 Key 的哈希一致时才能使用过滤器和哈希索引：
+  // 同一类型，或都按字节哈希
+  template <typename K>
+  static constexpr bool hashable_lookup_v =
+      has_key_hash<K>::value &&
+      (std::is_same_v<K, Key> ||
+       (has_key_prefix_v<K> && has_key_prefix_v<Key>));
+
+  template <typename K>
+  static uint64_t key_hash(const K& key) {
+    return SkipListKeyHash<K>::hash(key);
+  }
+
+  // 只在开启了过滤器或哈希索引时才会调用，Key 不可哈希时不会走到这里
+  static uint64_t node_hash(const SkipListNode<Key, Value>* node) {
+    if constexpr (has_key_hash<Key>::value) {
+      return key_hash(node->key_);
+    } else {
+      return 0;
+    }
+  }
+
+  // 过滤器确定哈希为 hash 的键不在表中时返回 true
+  bool filter_excludes(uint64_t hash) const {
+    return bloom_ && !bloom_->may_contain(hash);
+  }
+
+  // 通过哈希索引查找 key 所在的节点，找不到返回空
+  template <typename K>
+  SkipListNode<Key, Value>* index_find(const K& key, uint64_t hash) const {
+    return static_cast<SkipListNode<Key, Value>*>(
+        index_->find(hash, [&](void* node) {
+          return compare_(static_cast<SkipListNode<Key, Value>*>(node)->key_,
+                          key) == 0;
+        }));
+  }
+
+  // 不经过跳表的各层定位 key：过滤器排除时返回 true 且 *node 为空，
+  // 哈希索引找到时返回 true 且 *node 为所在节点；
+  // 两者都不能回答时返回 false，由调用方自顶向下查找
+  template <typename K>
+  bool hashed_lookup(const K& key, SkipListNode<Key, Value>** node) const {
+    if constexpr (hashable_lookup_v<K>) {
+      if (bloom_ || index_) {
+        uint64_t hash = key_hash(key);
+        *node = nullptr;
+        if (filter_excludes(hash)) {
+          return true;
+        }
+        if (index_) {
+          *node = index_find(key, hash);
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  // 比较 node 的键与 key，prefix 为 lookup_prefix(key)。
+  // 带内联前缀时先比较前缀整数，前缀相同才调用比较器
+  template <typename K>
+  int compare_node(const SkipListNode<Key, Value>* node, const K& key,
+                   uint64_t prefix) const {
+    if constexpr (has_key_prefix_v<K>) {
+      if (prefixed_ && node->prefix() != prefix) {
+        return node->prefix() < prefix ? -1 : 1;
+      }
+    }
+    return compare_(node->key_, key);
+  }
+
+  // 查找时实际参与比较的键：K 就是 Key 或比较器透明时原样返回引用，
+  // 否则构造一个 Key
+  template <typename K>
+  static decltype(auto) lookup_key(const K& key) {
+    if constexpr (std::is_same_v<K, Key> ||
+                  is_transparent_comparator<Comparator>::value) {
+      return (key);
+    } else {
+      return Key(key);
+    }
+  }
+
+  // 自顶向下逐层查找第一个使 before(node) 为 false 的节点，找不到返回空。
+  // before 须随键单调：前面一段节点为 true，其后全部为 false
+  template <typename Before>
+  SkipListNode<Key, Value>* find_first(Before&& before) const;
+
+  // 单写多读模式下登记 epoch，供迭代器在整个生命周期内持有
+  std::shared_ptr<EpochManager::Guard> pin() const;
+
+  // 交给 EpochManager 延迟释放被摘除的节点
+  void retire(SkipListNode<Key, Value>* node);
+
+  static void free_retired(void* node, void* arena) {
+    SkipListNode<Key, Value>::destroy(
+        static_cast<SkipListNode<Key, Value>*>(node),
+        static_cast<Arena*>(arena));
+  }
 };
 
 #endif  // SKIPLIST_H
@@ -0,0 +1,434 @@
+//
+// Created by Koschei on 2025/3/2.
+//
+
+#include "sst.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include "coding.h"
+
+namespace {
+
+constexpr uint64_t kSstMagic = 0x5453534C494B5331ull;  // "1SKILSST"
+constexpr size_t kFooterSize = 32;
+constexpr size_t kBlockTrailerSize = 4;
+
+[[noreturn]] void throw_errno(const char* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+[[noreturn]] void throw_corruption(const char* what) {
+  throw std::runtime_error(std::string("corrupted sst: ") + what);
+}
+
+void pread_all(int fd, char* buf, size_t size, uint64_t offset) {
+  while (size > 0) {
+    ssize_t n = ::pread(fd, buf, size, static_cast<off_t>(offset));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw_errno("read sst");
+    }
+    if (n == 0) {
+      throw_corruption("unexpected end of file");
+    }
+    buf += n;
+    size -= n;
+    offset += n;
+  }
+}
+
+}  // namespace
+
+SstWriter::BlockBuilder::BlockBuilder(int restart_interval)
+    : restart_interval_(restart_interval), restarts_{0}, counter_(0) {}
+
+void SstWriter::BlockBuilder::add(std::string_view key, std::string_view value,
+                                  bool deletion) {
+  size_t shared = 0;
+  if (counter_ < restart_interval_) {
+    size_t limit = std::min(last_key_.size(), key.size());
+    while (shared < limit && last_key_[shared] == key[shared]) {
+      ++shared;
+    }
+  } else {
+    restarts_.push_back(static_cast<uint32_t>(buffer_.size()));
+    counter_ = 0;
+  }
+  put_varint64(&buffer_, shared);
+  put_varint64(&buffer_, key.size() - shared);
+  put_varint64(&buffer_, (value.size() << 1) | (deletion ? 1 : 0));
+  buffer_.append(key.data() + shared, key.size() - shared);
+  buffer_.append(value.data(), value.size());
+
+  last_key_.resize(shared);
+  last_key_.append(key.data() + shared, key.size() - shared);
+  ++counter_;
+}
+
+const std::string& SstWriter::BlockBuilder::finish() {
+  for (uint32_t restart : restarts_) {
+    put_fixed32(&buffer_, restart);
+  }
+  put_fixed32(&buffer_, static_cast<uint32_t>(restarts_.size()));
+  return buffer_;
+}
+
+void SstWriter::BlockBuilder::reset() {
+  buffer_.clear();
+  restarts_.assign(1, 0);
+  counter_ = 0;
+  last_key_.clear();
+}
+
+SstWriter::SstWriter(const std::string& path, const SstOptions& options)
+    : options_(options),
+      data_block_(options.restart_interval),
+      index_block_(1),
+      buffer_(static_cast<char*>(
+          std::aligned_alloc(kSstAlignment, options.write_buffer_size))),
+      buffered_(0),
+      offset_(0),
+      entries_(0),
+      blocks_(0),
+      finished_(false) {
+  assert(options_.write_buffer_size % kSstAlignment == 0);
+  if (!buffer_) {
+    throw std::bad_alloc();
+  }
+  fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ < 0) {
+    throw_errno("open sst");
+  }
+}
+
+SstWriter::~SstWriter() {
+  if (!finished_) {
+    ::close(fd_);
+  }
+}
+
+void SstWriter::add(std::string_view key, std::string_view value) {
+  add_entry(key, value, false);
+}
+
+void SstWriter::add_deletion(std::string_view key) {
+  add_entry(key, {}, true);
+}
+
+void SstWriter::add_entry(std::string_view key, std::string_view value,
+                          bool deletion) {
+  assert(!finished_);
+  // 数据块刚结束时，上一个键是索引块中最后一条记录的键
+  if (entries_ > 0 &&
+      !(std::string_view(data_block_.empty() ? index_block_.last_key()
+                                             : data_block_.last_key()) < key)) {
+    throw std::invalid_argument("sst keys must be strictly increasing");
+  }
+  data_block_.add(key, value, deletion);
+  ++entries_;
+  if (data_block_.size_estimate() >= options_.block_size) {
+    flush_block();
+  }
+}
+
+void SstWriter::flush_block() {
+  if (data_block_.empty()) {
+    return;
+  }
+  const std::string& contents = data_block_.finish();
+  uint64_t offset = write_block(contents);
+  std::string handle;
+  put_varint64(&handle, offset);
+  put_varint64(&handle, contents.size());
+  index_block_.add(data_block_.last_key(), handle, false);
+  data_block_.reset();
+  ++blocks_;
+}
+
+uint64_t SstWriter::write_block(const std::string& contents) {
+  uint64_t offset = get_file_size();
+  append(contents);
+  std::string trailer;
+  put_fixed32(&trailer, crc32c(contents.data(), contents.size()));
+  append(trailer);
+  return offset;
+}
+
+void SstWriter::append(std::string_view bytes) {
+  while (!bytes.empty()) {
+    size_t n = std::min(bytes.size(), options_.write_buffer_size - buffered_);
+    std::memcpy(buffer_.get() + buffered_, bytes.data(), n);
+    buffered_ += n;
+    bytes.remove_prefix(n);
+    if (buffered_ == options_.write_buffer_size) {
+      write_buffer(buffered_);
+    }
+  }
+}
+
+void SstWriter::write_buffer(size_t bytes) {
+  const char* p = buffer_.get();
+  size_t left = bytes;
+  while (left > 0) {
+    ssize_t n = ::write(fd_, p, left);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw_errno("write sst");
+    }
+    p += n;
+    left -= n;
+  }
+  offset_ += bytes;
+  buffered_ = 0;
+}
+
+void SstWriter::finish() {
+  assert(!finished_);
+  flush_block();
+  const std::string& index = index_block_.finish();
+  uint64_t index_offset = write_block(index);
+
+  std::string footer;
+  put_fixed64(&footer, index_offset);
+  put_fixed64(&footer, index.size());
+  put_fixed64(&footer, entries_);
+  put_fixed64(&footer, kSstMagic);
+  append(footer);
+  write_buffer(buffered_);
+
+  finished_ = true;
+  if (::fdatasync(fd_) != 0) {
+    ::close(fd_);
+    throw_errno("sync sst");
+  }
+  if (::close(fd_) != 0) {
+    throw_errno("close sst");
+  }
+}
+
+SstReader::SstReader(const std::string& path) : entries_(0), block_reads_(0) {
+  fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) {
+    throw_errno("open sst");
+  }
+  try {
+    off_t file_size = ::lseek(fd_, 0, SEEK_END);
+    if (file_size < 0) {
+      throw_errno("seek sst");
+    }
+    if (static_cast<size_t>(file_size) < kFooterSize) {
+      throw_corruption("file too short");
+    }
+    char footer[kFooterSize];
+    pread_all(fd_, footer, kFooterSize, file_size - kFooterSize);
+    if (get_fixed64(footer + 24) != kSstMagic) {
+      throw_corruption("bad magic number");
+    }
+    uint64_t index_offset = get_fixed64(footer);
+    uint64_t index_size = get_fixed64(footer + 8);
+    entries_ = get_fixed64(footer + 16);
+    if (index_offset + index_size + kBlockTrailerSize + kFooterSize !=
+        static_cast<uint64_t>(file_size)) {
+      throw_corruption("bad index handle");
+    }
+
+    // 索引块的重启间隔为 1，每条记录都带完整的键，顺序解码即可
+    std::string index = read_block(index_offset, index_size);
+    uint32_t num_restarts = get_fixed32(index.data() + index.size() - 4);
+    const char* p = index.data();
+    const char* limit = index.data() + index.size() - 4 - num_restarts * 4;
+    while (p < limit) {
+      uint64_t shared, unshared, value_info, offset, size;
+      if (!get_varint64(&p, limit, &shared) ||
+          !get_varint64(&p, limit, &unshared) ||
+          !get_varint64(&p, limit, &value_info) || shared != 0 ||
+          unshared + (value_info >> 1) > static_cast<uint64_t>(limit - p)) {
+        throw_corruption("bad index entry");
+      }
+      std::string key(p, unshared);
+      p += unshared;
+      const char* value_limit = p + (value_info >> 1);
+      if (!get_varint64(&p, value_limit, &offset) ||
+          !get_varint64(&p, value_limit, &size)) {
+        throw_corruption("bad block handle");
+      }
+      p = value_limit;
+      index_.push_back({std::move(key), offset, size});
+    }
+  } catch (...) {
+    ::close(fd_);
+    throw;
+  }
+  block_reads_.store(0, std::memory_order_relaxed);
+}
+
+SstReader::~SstReader() { ::close(fd_); }
+
+std::string SstReader::read_block(uint64_t offset, uint64_t size) const {
+  std::string block(size + kBlockTrailerSize, '\0');
+  pread_all(fd_, block.data(), block.size(), offset);
+  if (crc32c(block.data(), size) != get_fixed32(block.data() + size)) {
+    throw_corruption("block checksum mismatch");
+  }
+  block.resize(size);
+  // 块至少有一个重启点，查找时从最后一个重启点开始二分
+  uint32_t num_restarts = size < 4 ? 0 : get_fixed32(block.data() + size - 4);
+  if (num_restarts == 0 || num_restarts * 4ull + 4 > size) {
+    throw_corruption("bad restart array");
+  }
+  block_reads_.fetch_add(1, std::memory_order_relaxed);
+  return block;
+}
+
+size_t SstReader::find_block(std::string_view key) const {
+  return std::lower_bound(index_.begin(), index_.end(), key,
+                          [](const IndexEntry& entry, std::string_view k) {
+                            return std::string_view(entry.last_key) < k;
+                          }) -
+         index_.begin();
+}
+
+SstReader::LookupResult SstReader::get(std::string_view key,
+                                       std::string* value) const {
+  auto it = seek(key);
+  if (!it.valid() || it.key() != key) {
+    return LookupResult::kNotFound;
+  }
+  if (it.is_deletion()) {
+    return LookupResult::kDeleted;
+  }
+  value->assign(it.value());
+  return LookupResult::kFound;
+}
+
+SstReader::Iterator SstReader::begin() const {
+  Iterator it(this);
+  it.load_block(0);
+  return it;
+}
+
+SstReader::Iterator SstReader::seek(std::string_view key) const {
+  // 所在块的最后一个键 >= key，块内必然能找到第一个 >= key 的记录
+  Iterator it(this);
+  size_t block = find_block(key);
+  it.block_ = block;
+  if (block < index_.size()) {
+    const auto& entry = index_[block];
+    it.data_ = read_block(entry.offset, entry.size);
+    it.num_restarts_ = get_fixed32(it.data_.data() + it.data_.size() - 4);
+    it.restarts_offset_ =
+        static_cast<uint32_t>(it.data_.size() - 4 - it.num_restarts_ * 4);
+    it.seek_in_block(key);
+  }
+  return it;
+}
+
+void SstReader::scan(
+    std::string_view start, std::string_view end,
+    const std::function<bool(std::string_view, std::string_view)>& callback)
+    const {
+  for (auto it = seek(start); it.valid() && it.key() < end; it.next()) {
+    if (!it.is_deletion() && !callback(it.key(), it.value())) {
+      return;
+    }
+  }
+}
+
+void SstReader::Iterator::load_block(size_t block) {
+  const auto& index = reader_->index_;
+  for (block_ = block; block_ < index.size(); ++block_) {
+    data_ = reader_->read_block(index[block_].offset, index[block_].size);
+    num_restarts_ = get_fixed32(data_.data() + data_.size() - 4);
+    restarts_offset_ =
+        static_cast<uint32_t>(data_.size() - 4 - num_restarts_ * 4);
+    pos_ = 0;
+    key_.clear();
+    if (parse_entry()) {
+      return;
+    }
+  }
+}
+
+void SstReader::Iterator::next() {
+  if (!parse_entry()) {
+    load_block(block_ + 1);
+  }
+}
+
+bool SstReader::Iterator::parse_entry() {
+  if (pos_ >= restarts_offset_) {
+    return false;
+  }
+  const char* p = data_.data() + pos_;
+  const char* limit = data_.data() + restarts_offset_;
+  uint64_t shared, unshared, value_info;
+  if (!get_varint64(&p, limit, &shared) ||
+      !get_varint64(&p, limit, &unshared) ||
+      !get_varint64(&p, limit, &value_info) || shared > key_.size() ||
+      unshared + (value_info >> 1) > static_cast<uint64_t>(limit - p)) {
+    throw_corruption("bad block entry");
+  }
+  key_.resize(shared);
+  key_.append(p, unshared);
+  p += unshared;
+  value_offset_ = static_cast<uint32_t>(p - data_.data());
+  value_size_ = static_cast<uint32_t>(value_info >> 1);
+  deletion_ = (value_info & 1) != 0;
+  pos_ = value_offset_ + value_size_;
+  return true;
+}
+
+void SstReader::Iterator::seek_to_restart(uint32_t restart) {
+  pos_ = get_fixed32(data_.data() + restarts_offset_ + restart * 4);
+  key_.clear();
+}
+
+std::string_view SstReader::Iterator::restart_key(uint32_t restart) const {
+  // 重启点处的记录不共享前缀，键可以直接从块中读出
+  const char* p =
+      data_.data() + get_fixed32(data_.data() + restarts_offset_ + restart * 4);
+  const char* limit = data_.data() + restarts_offset_;
+  uint64_t shared, unshared, value_info;
+  if (!get_varint64(&p, limit, &shared) ||
+      !get_varint64(&p, limit, &unshared) ||
+      !get_varint64(&p, limit, &value_info) || shared != 0 ||
+      unshared > static_cast<uint64_t>(limit - p)) {
+    throw_corruption("bad restart entry");
+  }
+  return std::string_view(p, unshared);
+}
+
+void SstReader::Iterator::seek_in_block(std::string_view key) {
+  // 找到最后一个键 < key 的重启点，从它开始向后线性查找
+  uint32_t lo = 0;
+  uint32_t hi = num_restarts_ - 1;
+  while (lo < hi) {
+    uint32_t mid = (lo + hi + 1) / 2;
+    if (restart_key(mid) < key) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  seek_to_restart(lo);
+  while (parse_entry()) {
+    if (std::string_view(key_) >= key) {
+      return;
+    }
+  }
+  // 索引保证块内存在 >= key 的记录，走到这里说明文件损坏
+  throw_corruption("key not found in block");
+}
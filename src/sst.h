@@ -0,0 +1,317 @@
+//
+// Created by Koschei on 2025/3/2.
+//
+
+#ifndef SST_H
+#define SST_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "skiplist.h"
+#include "wal.h"
+
+// 有序表文件（SST）的布局：
+//   数据块 1 | ... | 数据块 n | 索引块 | footer
+// 每个块末尾跟 4 字节的 CRC32C。块内记录为
+//   共享前缀长度 | 非共享长度 | (值长度 << 1 | 删除标记) | 键的非共享部分 | 值
+// 三个长度均为变长整数。每隔 restart_interval 条记录设一个重启点，
+// 重启点处的键不做前缀压缩，块尾依次存放各重启点的偏移和重启点个数。
+// 索引块格式相同，每个数据块一条：键为该块的最后一个键，值为块的偏移和长度。
+// footer 固定 32 字节：索引块偏移、索引块长度、记录数、魔数。
+// 键按字节序比较，写入时须严格升序
+struct SstOptions {
+  size_t block_size = 4096;  // 数据块达到该大小后结束
+  int restart_interval = 16;
+  // 写缓冲的大小，须为 kSstAlignment 的倍数
+  size_t write_buffer_size = 1 << 20;
+};
+
+// 写缓冲的对齐粒度，缓冲区起始地址和每次写出的长度（最后一次除外）
+// 都按它对齐
+constexpr size_t kSstAlignment = 4096;
+
+// 流式写出 SST：记录先编码进当前数据块，块满后追加到对齐的写缓冲，
+// 缓冲写满时整块 write 一次，不会每条记录一次系统调用。
+// 文件读写出错时抛出 std::system_error，键不是严格升序时抛出
+// std::invalid_argument
+class SstWriter {
+ public:
+  explicit SstWriter(const std::string& path, const SstOptions& options = {});
+
+  SstWriter(const SstWriter&) = delete;
+
+  SstWriter& operator=(const SstWriter&) = delete;
+
+  // 未调用 finish 时文件不完整
+  ~SstWriter();
+
+  void add(std::string_view key, std::string_view value);
+
+  // 写入删除标记，使更旧的表中的同一个键失效
+  void add_deletion(std::string_view key);
+
+  // 写出最后一个数据块、索引块和 footer，fdatasync 后关闭文件
+  void finish();
+
+  uint64_t get_entry_count() const { return entries_; }
+
+  uint64_t get_block_count() const { return blocks_; }
+
+  // 已写入（含缓冲中）的字节数，finish 后即文件大小
+  uint64_t get_file_size() const { return offset_ + buffered_; }
+
+ private:
+  // 组装一个块，数据块与索引块共用
+  class BlockBuilder {
+   public:
+    explicit BlockBuilder(int restart_interval);
+
+    void add(std::string_view key, std::string_view value, bool deletion);
+
+    // 追加重启点数组，返回完整的块内容
+    const std::string& finish();
+
+    void reset();
+
+    bool empty() const { return buffer_.empty(); }
+
+    size_t size_estimate() const {
+      return buffer_.size() + restarts_.size() * 4 + 4;
+    }
+
+    const std::string& last_key() const { return last_key_; }
+
+   private:
+    int restart_interval_;
+    std::string buffer_;
+    std::vector<uint32_t> restarts_;
+    int counter_;  // 距上一个重启点的记录数
+    std::string last_key_;
+  };
+
+  struct FreeDeleter {
+    void operator()(char* p) const { std::free(p); }
+  };
+
+  void add_entry(std::string_view key, std::string_view value, bool deletion);
+
+  // 结束当前数据块并为它写一条索引
+  void flush_block();
+
+  // 把块内容及其校验和追加到文件，返回块的偏移
+  uint64_t write_block(const std::string& contents);
+
+  void append(std::string_view bytes);
+
+  // 写出缓冲中的前 bytes 个字节
+  void write_buffer(size_t bytes);
+
+  int fd_;
+  SstOptions options_;
+  BlockBuilder data_block_;
+  BlockBuilder index_block_;
+  std::unique_ptr<char, FreeDeleter> buffer_;  // 按 kSstAlignment 对齐
+  size_t buffered_;
+  uint64_t offset_;  // 已经 write 到文件的字节数
+  uint64_t entries_;
+  uint64_t blocks_;
+  bool finished_;
+};
+
+// 读取 SST：打开时把 footer 和索引块读入内存，
+// 之后每次点查只需一次 pread 读取一个数据块。
+// 可被多个线程并发读取。文件损坏时抛出 std::runtime_error
+class SstReader {
+ public:
+  enum class LookupResult {
+    kNotFound,
+    kFound,
+    kDeleted,  // 找到删除标记
+  };
+
+  // 按键升序遍历记录（包括删除标记），顺序读入各数据块
+  class Iterator {
+   public:
+    bool valid() const { return block_ < reader_->index_.size(); }
+
+    void next();
+
+    std::string_view key() const { return key_; }
+
+    std::string_view value() const {
+      return std::string_view(data_).substr(value_offset_, value_size_);
+    }
+
+    bool is_deletion() const { return deletion_; }
+
+   private:
+    friend class SstReader;
+
+    explicit Iterator(const SstReader* reader) : reader_(reader) {}
+
+    // 载入第 block 个数据块并定位到第一条记录，越过末尾时迭代器失效
+    void load_block(size_t block);
+
+    // 在当前块中定位到第一个 >= key 的记录
+    void seek_in_block(std::string_view key);
+
+    // 解码 pos_ 处的记录，当前块没有更多记录时返回 false
+    bool parse_entry();
+
+    void seek_to_restart(uint32_t restart);
+
+    std::string_view restart_key(uint32_t restart) const;
+
+    const SstReader* reader_;
+    size_t block_ = 0;
+    std::string data_;  // 当前数据块
+    uint32_t restarts_offset_ = 0;
+    uint32_t num_restarts_ = 0;
+    uint32_t pos_ = 0;  // 下一条记录的偏移
+    std::string key_;
+    uint32_t value_offset_ = 0;
+    uint32_t value_size_ = 0;
+    bool deletion_ = false;
+  };
+
+  explicit SstReader(const std::string& path);
+
+  SstReader(const SstReader&) = delete;
+
+  SstReader& operator=(const SstReader&) = delete;
+
+  ~SstReader();
+
+  // 找到时把值写入 *value
+  LookupResult get(std::string_view key, std::string* value) const;
+
+  Iterator begin() const;
+
+  // 第一个 >= key 的记录：在索引中二分找到数据块，再在块内按重启点二分
+  Iterator seek(std::string_view key) const;
+
+  // 按升序对 [start, end) 内未删除的每条记录调用 callback(key, value)，
+  // 返回 false 时提前结束
+  void scan(std::string_view start, std::string_view end,
+            const std::function<bool(std::string_view, std::string_view)>&
+                callback) const;
+
+  uint64_t get_entry_count() const { return entries_; }
+
+  uint64_t get_block_count() const { return index_.size(); }
+
+  // 累计读取的数据块数
+  uint64_t get_block_reads() const {
+    return block_reads_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct IndexEntry {
+    std::string last_key;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  // 读取并校验一个块，返回不含校验和的内容
+  std::string read_block(uint64_t offset, uint64_t size) const;
+
+  // 第一个最后一个键 >= key 的数据块
+  size_t find_block(std::string_view key) const;
+
+  int fd_;
+  std::vector<IndexEntry> index_;
+  uint64_t entries_;
+  mutable std::atomic<uint64_t> block_reads_;
+};
+
+template <typename T>
+struct is_optional : std::false_type {};
+
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename T>
+struct dependent_false : std::false_type {};
+
+// SST 中键的编码，编码后的字节序须与键的比较顺序一致。
+// WalCodec 按内存原样拷贝整数（小端），字节序与数值序不符，不能用于键
+template <typename T, typename = void>
+struct SstKeyCodec {
+  static_assert(dependent_false<T>::value,
+                "SstKeyCodec supports string-like and integral keys only");
+};
+
+// 字符串类型（std::string、std::string_view）直接记录其字节
+template <typename T>
+struct SstKeyCodec<T, std::enable_if_t<std::is_same_v<T, std::string> ||
+                                       std::is_same_v<T, std::string_view>>> {
+  static void encode(const T& v, std::string* out) {
+    out->append(v.data(), v.size());
+  }
+
+  static T decode(std::string_view bytes) { return T(bytes); }
+};
+
+// 整数按大端写出，有符号数翻转符号位，使负数排在非负数之前
+template <typename T>
+struct SstKeyCodec<T, std::enable_if_t<std::is_integral_v<T>>> {
+  using Unsigned = std::make_unsigned_t<T>;
+
+  static constexpr Unsigned kSignFlip =
+      std::is_signed_v<T> ? Unsigned(Unsigned{1} << (sizeof(T) * 8 - 1)) : 0;
+
+  static void encode(T v, std::string* out) {
+    Unsigned u = static_cast<Unsigned>(v) ^ kSignFlip;
+    for (int shift = (sizeof(T) - 1) * 8; shift >= 0; shift -= 8) {
+      out->push_back(static_cast<char>(u >> shift));
+    }
+  }
+
+  static T decode(std::string_view bytes) {
+    Unsigned u = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      u = static_cast<Unsigned>(u << 8 | static_cast<uint8_t>(bytes[i]));
+    }
+    return static_cast<T>(u ^ kSignFlip);
+  }
+};
+
+// 把跳表按顺序写成 SST，返回文件大小。键经 SstKeyCodec、值经 WalCodec 编码，
+// 比较器的顺序须与编码后的字节序一致（字符串按字典序、整数按数值升序），
+// 否则 SstWriter 抛出 std::invalid_argument。
+// Value 为 std::optional 时（如 MemTable 的表）空值写为删除标记
+template <typename Key, typename Value, class Comparator>
+uint64_t write_sst(const SkipList<Key, Value, Comparator>& list,
+                   const std::string& path, const SstOptions& options = {}) {
+  SstWriter writer(path, options);
+  std::string key;
+  std::string value;
+  for (auto it = list.begin(); !it.is_end(); ++it) {
+    key.clear();
+    value.clear();
+    SstKeyCodec<Key>::encode(it.get_key(), &key);
+    if constexpr (is_optional<Value>::value) {
+      if (!it.get_value()) {
+        writer.add_deletion(key);
+        continue;
+      }
+      WalCodec<typename Value::value_type>::encode(*it.get_value(), &value);
+    } else {
+      WalCodec<Value>::encode(it.get_value(), &value);
+    }
+    writer.add(key, value);
+  }
+  writer.finish();
+  return writer.get_file_size();
+}
+
+#endif  // SST_H
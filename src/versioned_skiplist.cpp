@@ -0,0 +1,107 @@
+//
+// Created by Koschei on 2025/3/3.
+//
+
+#include "versioned_skiplist.h"
+
+#include <type_traits>
+
+template <typename Key, typename Value, class Comparator>
+VersionedSkipList<Key, Value, Comparator>::VersionedSkipList(
+    Comparator cmp, const SkipListOptions& options)
+    : compare_(cmp),
+      list_(InternalComparator{cmp}, reader_options(options)),
+      last_sequence_(0) {}
+
+template <typename Key, typename Value, class Comparator>
+uint64_t VersionedSkipList<Key, Value, Comparator>::insert(Key key,
+                                                           Value value) {
+  uint64_t sequence = last_sequence_.load(std::memory_order_relaxed) + 1;
+  list_.insert(InternalKey{std::move(key), sequence},
+               std::optional<Value>(std::move(value)));
+  last_sequence_.store(sequence, std::memory_order_release);
+  return sequence;
+}
+
+template <typename Key, typename Value, class Comparator>
+uint64_t VersionedSkipList<Key, Value, Comparator>::erase(Key key) {
+  uint64_t sequence = last_sequence_.load(std::memory_order_relaxed) + 1;
+  list_.insert(InternalKey{std::move(key), sequence}, std::nullopt);
+  last_sequence_.store(sequence, std::memory_order_release);
+  return sequence;
+}
+
+template <typename Key, typename Value, class Comparator>
+std::optional<Value> VersionedSkipList<Key, Value, Comparator>::get(
+    const Key& key, Snapshot snapshot) const {
+  std::optional<Value> result;
+  list_.get_with(typename InternalComparator::Lookup{&key, snapshot.sequence},
+                 [&](const std::optional<Value>& value) { result = value; });
+  return result;
+}
+
+template <typename Key, typename Value, class Comparator>
+typename VersionedSkipList<Key, Value, Comparator>::Iterator
+VersionedSkipList<Key, Value, Comparator>::begin(Snapshot snapshot) const {
+  return Iterator(list_.begin(), snapshot.sequence, &compare_);
+}
+
+template <typename Key, typename Value, class Comparator>
+typename VersionedSkipList<Key, Value, Comparator>::Iterator
+VersionedSkipList<Key, Value, Comparator>::lower_bound(
+    const Key& key, Snapshot snapshot) const {
+  return Iterator(list_.lower_bound(typename InternalComparator::Lookup{
+                      &key, snapshot.sequence}),
+                  snapshot.sequence, &compare_);
+}
+
+template <typename Key, typename Value, class Comparator>
+template <typename Callback>
+void VersionedSkipList<Key, Value, Comparator>::scan(const Key& start,
+                                                     const Key& end,
+                                                     Callback&& callback,
+                                                     Snapshot snapshot) const {
+  for (auto it = lower_bound(start, snapshot);
+       !it.is_end() && compare_(it.get_key(), end) < 0; ++it) {
+    if constexpr (std::is_same_v<std::invoke_result_t<Callback, const Key&,
+                                                      const Value&>,
+                                 bool>) {
+      if (!callback(it.get_key(), it.get_value())) {
+        return;
+      }
+    } else {
+      callback(it.get_key(), it.get_value());
+    }
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+void VersionedSkipList<Key, Value, Comparator>::Iterator::settle() {
+  while (!cursor_.is_end()) {
+    if (cursor_.get_key().sequence > sequence_) {
+      ++cursor_;  // 快照之后的写入
+    } else if (!cursor_.get_value()) {
+      skip_versions();  // 快照下已删除
+    } else {
+      return;
+    }
+  }
+}
+
+template <typename Key, typename Value, class Comparator>
+void VersionedSkipList<Key, Value, Comparator>::Iterator::skip_versions() {
+  // 节点从不摘除，迭代器持有 epoch 期间 user_key 的引用一直有效
+  const Key& user_key = cursor_.get_key().user_key;
+  do {
+    ++cursor_;
+  } while (!cursor_.is_end() &&
+           (*compare_)(cursor_.get_key().user_key, user_key) == 0);
+}
+
+template <typename Key, typename Value, class Comparator>
+typename VersionedSkipList<Key, Value, Comparator>::Iterator&
+VersionedSkipList<Key, Value, Comparator>::Iterator::operator++() {
+  skip_versions();
+  settle();
+  return *this;
+}
@@ -0,0 +1,177 @@
+//
+// Created by Koschei on 2025/3/3.
+//
+
+#ifndef VERSIONED_SKIPLIST_H
+#define VERSIONED_SKIPLIST_H
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "skiplist.h"
+
+// 带序列号的内部键，同一个用户键的多个版本并存
+template <typename Key>
+struct VersionedKey {
+  Key user_key;
+  uint64_t sequence;
+};
+
+template <typename Key>
+struct SkipListSizeTraits<VersionedKey<Key>> {
+  static size_t size(const VersionedKey<Key>& k) {
+    return SkipListSizeTraits<Key>::size(k.user_key) + sizeof(uint64_t);
+  }
+
+  static size_t heap_size(const VersionedKey<Key>& k) {
+    return SkipListSizeTraits<Key>::heap_size(k.user_key);
+  }
+};
+
+// 内部键的顺序：用户键升序，同一用户键按序列号降序，新版本在前
+template <typename Key, class Comparator>
+struct VersionedKeyComparator {
+  using is_transparent = void;
+
+  // 在快照 sequence 下查找 user_key，不拷贝用户键。
+  // 同一用户键中序列号 <= sequence 的版本都与它比较为相等，
+  // 因此查找得到的第一个节点就是快照下可见的最新版本
+  struct Lookup {
+    const Key* user_key;
+    uint64_t sequence;
+  };
+
+  Comparator cmp;
+
+  int operator()(const VersionedKey<Key>& a, const VersionedKey<Key>& b) const {
+    int r = cmp(a.user_key, b.user_key);
+    if (r != 0) {
+      return r;
+    }
+    return a.sequence > b.sequence ? -1 : (a.sequence < b.sequence ? 1 : 0);
+  }
+
+  int operator()(const VersionedKey<Key>& a, const Lookup& b) const {
+    int r = cmp(a.user_key, *b.user_key);
+    if (r != 0) {
+      return r;
+    }
+    return a.sequence > b.sequence ? -1 : 0;
+  }
+};
+
+// 多版本跳表（MVCC）：每次 insert/erase 分配一个递增的序列号，
+// 以 (用户键, 序列号) 为键插入新节点，erase 写入删除标记（空值）。
+// 已链入的节点从不修改或摘除，读者通过 get_snapshot() 固定一个序列号，
+// 之后的写入对它不可见，长时间的扫描也能看到一致的视图。
+// 单写多读：写操作须串行调用，读操作可与写操作并发且不加锁。
+// 旧版本在表的生命周期内一直保留，由刷盘（或之后的压缩）清理
+template <typename Key, typename Value, class Comparator>
+class VersionedSkipList {
+ public:
+  using InternalKey = VersionedKey<Key>;
+  using InternalComparator = VersionedKeyComparator<Key, Comparator>;
+  // 值为空表示删除标记
+  using List = SkipList<InternalKey, std::optional<Value>, InternalComparator>;
+
+  // 读视图，序列号不超过 sequence 的写入可见
+  struct Snapshot {
+    uint64_t sequence;
+  };
+
+  // 在快照下按用户键升序遍历，每个用户键只出现一次（可见的最新版本），
+  // 被删除的键跳过
+  class Iterator {
+   public:
+    const Key& get_key() const { return cursor_.get_key().user_key; }
+
+    const Value& get_value() const { return *cursor_.get_value(); }
+
+    uint64_t get_sequence() const { return cursor_.get_key().sequence; }
+
+    bool is_end() const { return cursor_.is_end(); }
+
+    Iterator& operator++();
+
+   private:
+    friend class VersionedSkipList;
+
+    Iterator(typename List::Iterator cursor, uint64_t sequence,
+             const Comparator* compare)
+        : cursor_(std::move(cursor)), sequence_(sequence), compare_(compare) {
+      settle();
+    }
+
+    // 从 cursor_ 起跳过不可见的版本和被删除的键，停在下一个可见的值上
+    void settle();
+
+    // 跳过当前用户键剩余的旧版本
+    void skip_versions();
+
+    typename List::Iterator cursor_;
+    uint64_t sequence_;
+    const Comparator* compare_;
+  };
+
+  explicit VersionedSkipList(Comparator cmp,
+                             const SkipListOptions& options = {});
+
+  VersionedSkipList(const VersionedSkipList&) = delete;
+
+  VersionedSkipList& operator=(const VersionedSkipList&) = delete;
+
+  // 返回本次写入的序列号
+  uint64_t insert(Key key, Value value);
+
+  uint64_t erase(Key key);
+
+  Snapshot get_snapshot() const {
+    return {last_sequence_.load(std::memory_order_acquire)};
+  }
+
+  std::optional<Value> get(const Key& key) const {
+    return get(key, get_snapshot());
+  }
+
+  std::optional<Value> get(const Key& key, Snapshot snapshot) const;
+
+  bool contains(const Key& key, Snapshot snapshot) const {
+    return get(key, snapshot).has_value();
+  }
+
+  Iterator begin(Snapshot snapshot) const;
+
+  // 快照下第一个 >= key 的用户键
+  Iterator lower_bound(const Key& key, Snapshot snapshot) const;
+
+  // 按升序对快照下 [start, end) 内的每个用户键调用 callback(key, value)，
+  // callback 返回 bool 时，返回 false 会提前结束
+  template <typename Callback>
+  void scan(const Key& start, const Key& end, Callback&& callback,
+            Snapshot snapshot) const;
+
+  uint64_t get_last_sequence() const {
+    return last_sequence_.load(std::memory_order_acquire);
+  }
+
+  // 所有版本（含删除标记）的数据量，见 SkipList::get_size
+  size_t get_size() const { return list_.get_size(); }
+
+  // 底层的内部键表，刷盘时按 (用户键, 序列号降序) 遍历全部版本
+  const List& list() const { return list_; }
+
+ private:
+  static SkipListOptions reader_options(SkipListOptions options) {
+    options.concurrent_readers = true;
+    return options;
+  }
+
+  Comparator const compare_;
+  List list_;
+  // 最后一个已链入跳表的写入的序列号，写者链入节点后才以 release 发布
+  std::atomic<uint64_t> last_sequence_;
+};
+
+#endif  // VERSIONED_SKIPLIST_H
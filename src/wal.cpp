@@ -0,0 +1,284 @@
+//
+// Created by Koschei on 2025/3/1.
+//
+
+#include "wal.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <system_error>
+#include <vector>
+
+#include "coding.h"
+
+namespace {
+
+[[noreturn]] void throw_errno(const char* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+}  // namespace
+
+WriteAheadLog::WriteAheadLog(const std::string& path,
+                             const WalOptions& options, const Visitor& visitor)
+    : options_(options),
+      replayed_(0),
+      offset_(0),
+      error_(0),
+      records_(0),
+      groups_(0),
+      syncs_(0),
+      dirty_(false),
+      stop_(false) {
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd_ < 0) {
+    throw_errno("open wal");
+  }
+
+  std::string contents;
+  char buf[1 << 16];
+  ssize_t n;
+  while ((n = ::read(fd_, buf, sizeof(buf))) != 0) {
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ::close(fd_);
+      throw_errno("read wal");
+    }
+    contents.append(buf, n);
+  }
+  size_t valid;
+  try {
+    valid = replay(contents.data(), contents.size(), visitor, &replayed_);
+  } catch (...) {
+    ::close(fd_);
+    throw;
+  }
+  // 丢弃崩溃时写了一半的尾部，否则之后追加的记录无法被回放
+  if (valid < contents.size() && ::ftruncate(fd_, valid) != 0) {
+    ::close(fd_);
+    throw_errno("truncate wal");
+  }
+  if (::lseek(fd_, valid, SEEK_SET) < 0) {
+    ::close(fd_);
+    throw_errno("seek wal");
+  }
+  offset_ = valid;
+
+  if (options_.sync == WalSyncPolicy::kInterval) {
+    sync_thread_ = std::thread(&WriteAheadLog::sync_loop, this);
+  }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+  if (sync_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(sync_mutex_);
+      stop_ = true;
+    }
+    sync_cv_.notify_all();
+    sync_thread_.join();
+  }
+  if (options_.sync != WalSyncPolicy::kNone) {
+    ::fdatasync(fd_);
+  }
+  ::close(fd_);
+}
+
+void WriteAheadLog::encode_record(RecordType type, std::string_view key,
+                                  std::string_view value, std::string* out) {
+  size_t start = out->size();
+  out->resize(start + 8);  // crc 和长度最后回填
+  out->push_back(static_cast<char>(type));
+  put_fixed32(out, static_cast<uint32_t>(key.size()));
+  out->append(key.data(), key.size());
+  out->append(value.data(), value.size());
+
+  size_t length = out->size() - start - 8;
+  uint32_t crc = crc32c(out->data() + start + 8, length);
+  auto len32 = static_cast<uint32_t>(length);
+  std::memcpy(&(*out)[start], &crc, sizeof(crc));
+  std::memcpy(&(*out)[start + 4], &len32, sizeof(len32));
+}
+
+size_t WriteAheadLog::replay(const char* data, size_t size,
+                             const Visitor& visitor, uint64_t* records) {
+  size_t pos = 0;
+  while (size - pos >= kHeaderSize) {
+    const char* header = data + pos;
+    uint32_t crc = get_fixed32(header);
+    uint32_t length = get_fixed32(header + 4);
+    // length 至少包含 type 和 key 长度
+    if (length < 1 + 4 || length > size - pos - 8 ||
+        crc32c(header + 8, length) != crc) {
+      break;
+    }
+    auto type = static_cast<RecordType>(header[8]);
+    uint32_t key_size = get_fixed32(header + 9);
+    if (key_size > length - 5 ||
+        (type != RecordType::kInsert && type != RecordType::kErase)) {
+      break;
+    }
+    const char* key = header + 13;
+    if (visitor) {
+      visitor(type, std::string_view(key, key_size),
+              std::string_view(key + key_size, length - 5 - key_size));
+    }
+    ++*records;
+    pos += 8 + length;
+  }
+  return pos;
+}
+
+void WriteAheadLog::write_all(const std::string& bytes) {
+  const char* p = bytes.data();
+  size_t left = bytes.size();
+  while (left > 0) {
+    ssize_t n = ::write(fd_, p, left);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw_errno("write wal");
+    }
+    p += n;
+    left -= n;
+  }
+}
+
+void WriteAheadLog::check_failed() const {
+  int err = error_.load(std::memory_order_acquire);
+  if (err != 0) {
+    throw std::system_error(err, std::generic_category(), "wal failed");
+  }
+}
+
+void WriteAheadLog::set_failed(int err) {
+  int expected = 0;
+  error_.compare_exchange_strong(expected, err, std::memory_order_release,
+                                 std::memory_order_relaxed);
+}
+
+void WriteAheadLog::rollback() {
+  if (::ftruncate(fd_, static_cast<off_t>(offset_)) != 0 ||
+      ::lseek(fd_, static_cast<off_t>(offset_), SEEK_SET) < 0) {
+    set_failed(errno);
+  }
+}
+
+void WriteAheadLog::append(RecordType type, std::string_view key,
+                           std::string_view value,
+                           const std::function<void()>& apply) {
+  // 编码和校验在加锁前完成
+  std::string record;
+  encode_record(type, key, value, &record);
+
+  Writer w;
+  w.record = &record;
+  w.apply = &apply;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  writers_.push_back(&w);
+  w.cv.wait(lock, [&] { return w.done || writers_.front() == &w; });
+  if (w.done) {
+    if (w.error) {
+      std::rethrow_exception(w.error);
+    }
+    return;
+  }
+
+  // 成为 leader：带上队列中已有的写者，直到凑满一组
+  group_buffer_.clear();
+  auto last = writers_.begin();
+  for (; last != writers_.end(); ++last) {
+    if (!group_buffer_.empty() &&
+        group_buffer_.size() + (*last)->record->size() >
+            options_.max_group_bytes) {
+      break;
+    }
+    group_buffer_ += *(*last)->record;
+  }
+  // 解锁后其他线程会继续入队，本组的写者需先拷贝出来
+  std::vector<Writer*> group(writers_.begin(), last);
+  lock.unlock();
+
+  // 要等本组出队后才会产生下一个 leader，write 与 apply 不会并发
+  std::exception_ptr error;
+  try {
+    check_failed();
+    try {
+      write_all(group_buffer_);
+      if (options_.sync == WalSyncPolicy::kEveryWrite) {
+        if (::fdatasync(fd_) != 0) {
+          throw_errno("sync wal");
+        }
+        syncs_.fetch_add(1, std::memory_order_relaxed);
+      }
+    } catch (...) {
+      // 本组的记录不会被确认，截断后下一组从这里接着写
+      rollback();
+      throw;
+    }
+    offset_ += group_buffer_.size();
+    groups_.fetch_add(1, std::memory_order_relaxed);
+    records_.fetch_add(group.size(), std::memory_order_relaxed);
+    if (options_.sync == WalSyncPolicy::kInterval) {
+      dirty_.store(true, std::memory_order_relaxed);
+    }
+    for (Writer* writer : group) {
+      if (*writer->apply) {
+        (*writer->apply)();
+      }
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  lock.lock();
+  for (Writer* writer : group) {
+    writers_.pop_front();
+    if (writer != &w) {
+      writer->error = error;
+      writer->done = true;
+      writer->cv.notify_one();
+    }
+  }
+  if (!writers_.empty()) {
+    writers_.front()->cv.notify_one();
+  }
+  lock.unlock();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void WriteAheadLog::sync() {
+  if (::fdatasync(fd_) != 0) {
+    // 已确认的记录可能没有持久化，不能再继续追加
+    set_failed(errno);
+    throw_errno("sync wal");
+  }
+  syncs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void WriteAheadLog::sync_loop() {
+  std::unique_lock<std::mutex> lock(sync_mutex_);
+  while (!stop_) {
+    sync_cv_.wait_for(lock,
+                      std::chrono::milliseconds(options_.sync_interval_ms));
+    if (dirty_.exchange(false, std::memory_order_relaxed)) {
+      if (::fdatasync(fd_) != 0) {
+        // 已确认的记录没有持久化：保持 dirty_，之后的 append 抛出异常
+        dirty_.store(true, std::memory_order_relaxed);
+        set_failed(errno);
+        continue;
+      }
+      syncs_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
@@ -0,0 +1,186 @@
+//
+// Created by Koschei on 2025/3/1.
+//
+
+#ifndef WAL_H
+#define WAL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+// 日志何时落盘
+enum class WalSyncPolicy {
+  kEveryWrite,  // 每组写入后 fdatasync，append 返回即持久
+  // 后台线程每隔 sync_interval_ms 落盘一次，落盘失败后 append 抛出异常
+  kInterval,
+  kNone,        // 只 write 到页缓存，由操作系统决定何时落盘
+};
+
+struct WalOptions {
+  WalSyncPolicy sync = WalSyncPolicy::kEveryWrite;
+  int sync_interval_ms = 10;
+  // 一次组提交最多合并的字节数，超过后剩余的写入留给下一组
+  size_t max_group_bytes = 1 << 20;
+};
+
+// 键值与日志字节之间的转换，可针对自定义类型特化：
+// - encode：把 v 的字节追加到 out
+// - decode：由 encode 产生的字节还原对象
+// 默认按内存表示原样拷贝，要求 T 可平凡复制。
+// 字节数与类型不符（如用不同的键值类型打开日志）时抛出 std::runtime_error
+template <typename T, typename = void>
+struct WalCodec {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "WalCodec needs a specialization for this type");
+
+  static void encode(const T& v, std::string* out) {
+    out->append(reinterpret_cast<const char*>(&v), sizeof(T));
+  }
+
+  static T decode(std::string_view bytes) {
+    if (bytes.size() != sizeof(T)) {
+      throw std::runtime_error("corrupted wal: bad field size");
+    }
+    T v;
+    std::memcpy(&v, bytes.data(), sizeof(T));
+    return v;
+  }
+};
+
+// 字符串类型（std::string、std::string_view）直接记录其字节
+template <typename T>
+struct WalCodec<T, std::enable_if_t<std::is_same_v<T, std::string> ||
+                                    std::is_same_v<T, std::string_view>>> {
+  static void encode(const T& v, std::string* out) {
+    out->append(v.data(), v.size());
+  }
+
+  static T decode(std::string_view bytes) { return T(bytes); }
+};
+
+// 预写日志：每次 insert/erase 追加一条带 CRC32C 校验的记录，格式为
+//   crc32c (4) | payload 长度 (4) | type (1) | key 长度 (4) | key | value
+// crc 覆盖 type 及之后的全部字节。
+// 组提交：并发的 append 排队，队首的写者作为 leader 把队列中的记录
+// 拼成一次 write（按策略再加一次 fdatasync），然后按日志顺序调用各记录的
+// apply 回调并唤醒其他写者。同一时刻只有一个 leader，因此 apply
+// 总是串行执行，顺序与日志一致。
+// 文件读写出错时抛出 std::system_error
+class WriteAheadLog {
+ public:
+  enum class RecordType : uint8_t {
+    kInsert = 1,
+    kErase = 2,
+  };
+
+  using Visitor = std::function<void(RecordType type, std::string_view key,
+                                     std::string_view value)>;
+
+  // 打开或创建 path 处的日志。已有记录按写入顺序交给 visitor 回放，
+  // 遇到截断或校验失败的记录时停止，并把文件截断到最后一条完整记录，
+  // 之后的写入追加在其后。传给 visitor 的 key 和 value 只在回调期间有效，
+  // visitor 抛出的异常原样传给调用方
+  explicit WriteAheadLog(const std::string& path,
+                         const WalOptions& options = {},
+                         const Visitor& visitor = {});
+
+  WriteAheadLog(const WriteAheadLog&) = delete;
+
+  WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+  // 落盘后关闭文件
+  ~WriteAheadLog();
+
+  // 追加一条记录，返回时记录已写入（kEveryWrite 下已持久化），
+  // 且 apply（可为空）已由 leader 按日志顺序调用。
+  // 一组写入或落盘失败时把文件截断回组开始前的长度，本组的写者都收到异常，
+  // 之后的记录不会跟在写了一半的记录后面；截断也失败，或者已确认的记录
+  // 落盘失败时日志进入失败状态，之后的 append 都抛出 std::system_error
+  void append(RecordType type, std::string_view key, std::string_view value,
+              const std::function<void()>& apply = {});
+
+  // 立即 fdatasync，失败时日志进入失败状态
+  void sync();
+
+  uint64_t get_record_count() const {
+    return records_.load(std::memory_order_relaxed);
+  }
+
+  // 组提交的次数，即 write 系统调用的次数
+  uint64_t get_group_count() const {
+    return groups_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t get_sync_count() const {
+    return syncs_.load(std::memory_order_relaxed);
+  }
+
+  // 启动时回放得到的记录数
+  uint64_t get_replayed_count() const { return replayed_; }
+
+ private:
+  static constexpr size_t kHeaderSize = 4 + 4 + 1;
+
+  // 排队等待提交的写者，位于调用方的栈上
+  struct Writer {
+    const std::string* record;
+    const std::function<void()>* apply;
+    bool done = false;
+    std::exception_ptr error;
+    std::condition_variable cv;
+  };
+
+  static void encode_record(RecordType type, std::string_view key,
+                            std::string_view value, std::string* out);
+
+  // 解析并回放 [data, data + size) 中的记录，返回完整记录的总长度
+  static size_t replay(const char* data, size_t size, const Visitor& visitor,
+                       uint64_t* records);
+
+  void write_all(const std::string& bytes);
+
+  // 日志已进入失败状态时抛出 std::system_error
+  void check_failed() const;
+
+  // 进入失败状态，err 为导致失败的 errno
+  void set_failed(int err);
+
+  // 截断写了一半的组，回到 offset_
+  void rollback();
+
+  void sync_loop();
+
+  int fd_;
+  WalOptions options_;
+  uint64_t replayed_;
+
+  std::mutex mutex_;             // 保护 writers_
+  std::deque<Writer*> writers_;  // 队首为当前 leader
+  std::string group_buffer_;     // 仅由 leader 使用
+  uint64_t offset_;              // 已确认记录的末尾，仅由 leader 使用
+  std::atomic<int> error_;       // 不为 0 时日志处于失败状态
+
+  std::atomic<uint64_t> records_;
+  std::atomic<uint64_t> groups_;
+  std::atomic<uint64_t> syncs_;
+
+  // kInterval 模式的后台落盘线程
+  std::atomic<bool> dirty_;
+  std::mutex sync_mutex_;  // 保护 stop_
+  std::condition_variable sync_cv_;
+  bool stop_;
+  std::thread sync_thread_;
+};
+
+#endif  // WAL_H
@@ -4,9 +4,31 @@
 
 #include "skiplist.h"
 #include "skiplist.cpp"
+#include "concurrent_skiplist.h"
+#include "concurrent_skiplist.cpp"
+#include "sharded_skiplist.h"
+#include "sharded_skiplist.cpp"
+#include "merging_iterator.h"
+#include "merging_iterator.cpp"
+#include "memtable.h"
+#include "memtable.cpp"
+#include "wal.h"
+#include "sst.h"
+#include "versioned_skiplist.h"
+#include "versioned_skiplist.cpp"
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string_view>
+#include <thread>
+
 const int benchInitSize = 10000;
 const int benchBatchSize = 10;
 
@@ -25,14 +47,77 @@ struct Comparator {
     }
 };
 
+// 统计堆上存活的字节数和分配次数，用于衡量每个条目的真实内存开销。
+// 只在 AllocationCounting 的作用域内计数，其余基准的分配不做原子操作
+static std::atomic<bool> g_count_allocs{false};
+static std::atomic<size_t> g_live_bytes{0};
+static std::atomic<size_t> g_live_allocs{0};
+// 累计的分配次数，只增不减
+static std::atomic<size_t> g_total_allocs{0};
+
+// 块头中大小的最高位标记该块计入了统计，释放时据此决定是否扣减
+constexpr std::size_t kCountedBit = ~(~std::size_t{0} >> 1);
+
+class AllocationCounting {
+public:
+    AllocationCounting() { g_count_allocs.store(true, std::memory_order_relaxed); }
+
+    AllocationCounting(const AllocationCounting &) = delete;
+
+    AllocationCounting &operator=(const AllocationCounting &) = delete;
+
+    ~AllocationCounting() { g_count_allocs.store(false, std::memory_order_relaxed); }
+};
+
+void *operator new(std::size_t size) {
+    // 在每块内存前记录其大小，释放时据此扣减
+    auto *block = static_cast<char *>(std::malloc(size + alignof(std::max_align_t)));
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    std::size_t header = size;
+    if (g_count_allocs.load(std::memory_order_relaxed)) {
+        header |= kCountedBit;
+        g_live_bytes.fetch_add(size, std::memory_order_relaxed);
+        g_live_allocs.fetch_add(1, std::memory_order_relaxed);
+        g_total_allocs.fetch_add(1, std::memory_order_relaxed);
+    }
+    *reinterpret_cast<std::size_t *>(block) = header;
+    return block + alignof(std::max_align_t);
+}
+
+// 不允许内联，避免 GCC 在调用点把 free 与 operator new 误判为不匹配
+[[gnu::noinline]] void operator delete(void *ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto *block = static_cast<char *>(ptr) - alignof(std::max_align_t);
+    std::size_t header = *reinterpret_cast<std::size_t *>(block);
+    if (header & kCountedBit) {
+        g_live_bytes.fetch_sub(header & ~kCountedBit, std::memory_order_relaxed);
+        g_live_allocs.fetch_sub(1, std::memory_order_relaxed);
+    }
+    std::free(block);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+// 先按键排序，再走批量构建的快速路径
 template<typename Key, typename Value, class Comparator>
-std::unique_ptr<SkipList<Key, Value, Comparator>> MakeSkipListN(int n) {
+std::unique_ptr<SkipList<Key, Value, Comparator>> MakeSkipListN(int n, const SkipListOptions &options = {}) {
     Comparator cmp;
-    auto sl = std::make_unique<SkipList<Key, Value, Comparator>>(cmp);
+    std::vector<std::pair<Key, Value>> entries;
+    entries.reserve(n);
     for (int i = 0; i < n; ++i) {
-        sl->insert(std::to_string(i), std::to_string(i));
+        entries.emplace_back(std::to_string(i), std::to_string(i));
     }
-    return sl;
+    std::sort(entries.begin(), entries.end(), [&](const auto &a, const auto &b) {
+        return cmp(a.first, b.first) < 0;
+    });
+    return std::make_unique<SkipList<Key, Value, Comparator>>(
+            cmp, std::make_move_iterator(entries.begin()), std::make_move_iterator(entries.end()), options);
 }
 
 std::map<std::string, std::string> MakeMapN(int n) {
@@ -82,6 +167,486 @@ void BenchmarkSkipList_Erase(benchmark::State &state) {
 
 BENCHMARK(BenchmarkSkipList_Erase);
 
+struct IntComparator {
+    int operator()(int a, int b) const {
+        if (a < b) {
+            return -1;
+        } else if (a > b) {
+            return +1;
+        } else {
+            return 0;
+        }
+    }
+};
+
+// 非字符串键值：大小统计走 SkipListSizeTraits，不再格式化成字符串
+void BenchmarkSkipList_Insert_Int(benchmark::State &state) {
+    auto start = benchInitSize;
+    SkipList<int, double, IntComparator> sl(IntComparator{});
+    for (int i = 0; i < start; ++i) {
+        sl.insert(i, i);
+    }
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            sl.insert(start + i, i);
+        }
+        start += benchBatchSize;
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_Insert_Int);
+
+// 旧的塔高生成方式：mt19937 + uniform_real_distribution，每晋升一层抽一次
+struct Mt19937LevelGenerator {
+    std::random_device rd;
+    std::mt19937 gen{rd()};
+    std::uniform_real_distribution<> dis{0.0, 1.0};
+
+    int level(int max_level, float probability) {
+        int level = 1;
+        while (dis(gen) < probability && level < max_level) {
+            ++level;
+        }
+        return level;
+    }
+};
+
+// 只测塔高生成，参数为晋升概率的倒数
+void BenchmarkLevelGenerator_Mt19937(benchmark::State &state) {
+    const float probability = 1.0f / state.range(0);
+    Mt19937LevelGenerator levels;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(levels.level(16, probability));
+    }
+}
+
+BENCHMARK(BenchmarkLevelGenerator_Mt19937)->Arg(2)->Arg(4);
+
+void BenchmarkLevelGenerator_Fast(benchmark::State &state) {
+    LevelGenerator levels(16, 1.0f / state.range(0));
+    Random64 rng(0);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(levels.level(rng.next()));
+    }
+}
+
+BENCHMARK(BenchmarkLevelGenerator_Fast)->Arg(2)->Arg(4);
+
+// 在整数键插入循环中额外生成一次塔高，
+// 与 BenchmarkSkipList_Insert_Int 的差值即为该生成器给每次插入增加的开销
+template<typename Generator>
+void BenchmarkSkipList_Insert_WithGenerator(benchmark::State &state, Generator &&generate) {
+    auto start = benchInitSize;
+    SkipListOptions options;
+    options.seed = 0;
+    SkipList<int, double, IntComparator> sl(IntComparator{}, options);
+    for (int i = 0; i < start; ++i) {
+        sl.insert(i, i);
+    }
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            benchmark::DoNotOptimize(generate());
+            sl.insert(start + i, i);
+        }
+        start += benchBatchSize;
+    }
+}
+
+void BenchmarkSkipList_Insert_ExtraMt19937(benchmark::State &state) {
+    Mt19937LevelGenerator levels;
+    BenchmarkSkipList_Insert_WithGenerator(state, [&] { return levels.level(16, 0.5); });
+}
+
+BENCHMARK(BenchmarkSkipList_Insert_ExtraMt19937);
+
+void BenchmarkSkipList_Insert_ExtraFast(benchmark::State &state) {
+    LevelGenerator levels(16, 0.5);
+    Random64 rng(1);
+    BenchmarkSkipList_Insert_WithGenerator(state, [&] { return levels.level(rng.next()); });
+}
+
+BENCHMARK(BenchmarkSkipList_Insert_ExtraFast);
+
+// WriteBatch 式的批量写入：每批 256 个聚集在一段区间内的新键，
+// sorted 为 false 时打乱批内顺序
+std::vector<std::pair<Key, Value>> MakeClusteredBatch(int start, bool sorted, std::mt19937 &gen) {
+    const int batch_size = 256;
+    std::vector<std::pair<Key, Value>> batch;
+    for (int i = 0; i < batch_size; ++i) {
+        // 定长的键使字典序与数值序一致
+        auto key = std::to_string(1000000 + start + i);
+        batch.emplace_back(key, key);
+    }
+    if (!sorted) {
+        std::shuffle(batch.begin(), batch.end(), gen);
+    }
+    return batch;
+}
+
+void BenchmarkSkipList_InsertLoop(benchmark::State &state) {
+    auto sl = MakeSkipListN<std::string, std::string, Comparator>(benchInitSize);
+    std::mt19937 gen(0);
+    int start = 0;
+    for (auto _: state) {
+        state.PauseTiming();
+        auto batch = MakeClusteredBatch(start, state.range(0), gen);
+        start += batch.size();
+        state.ResumeTiming();
+        for (auto &[key, value]: batch) {
+            sl->insert(key, value);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 256);
+}
+
+BENCHMARK(BenchmarkSkipList_InsertLoop)->ArgName("sorted")->Arg(1)->Arg(0);
+
+void BenchmarkSkipList_InsertBatch(benchmark::State &state) {
+    auto sl = MakeSkipListN<std::string, std::string, Comparator>(benchInitSize);
+    std::mt19937 gen(0);
+    int start = 0;
+    for (auto _: state) {
+        state.PauseTiming();
+        auto batch = MakeClusteredBatch(start, state.range(0), gen);
+        start += batch.size();
+        state.ResumeTiming();
+        sl->insert_batch(batch.begin(), batch.end());
+    }
+    state.SetItemsProcessed(state.iterations() * 256);
+}
+
+BENCHMARK(BenchmarkSkipList_InsertBatch)->ArgName("sorted")->Arg(1)->Arg(0);
+
+// 启动时从有序数据重建跳表：逐个 insert 对照批量构建，参数为线程数
+const int startupSize = 10000000;
+
+std::vector<std::pair<int, int>> MakeSortedInts(int n) {
+    std::vector<std::pair<int, int>> entries;
+    entries.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        entries.emplace_back(i, i);
+    }
+    return entries;
+}
+
+void BenchmarkSkipList_Startup_Insert(benchmark::State &state) {
+    auto entries = MakeSortedInts(startupSize);
+    for (auto _: state) {
+        auto sl = std::make_unique<SkipList<int, int, IntComparator>>(IntComparator{});
+        for (auto &[key, value]: entries) {
+            sl->insert(key, value);
+        }
+        state.PauseTiming();  // 不计析构
+        sl.reset();
+        state.ResumeTiming();
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_Startup_Insert)->Unit(benchmark::kMillisecond)->Iterations(1);
+
+void BenchmarkSkipList_Startup_BulkLoad(benchmark::State &state) {
+    auto entries = MakeSortedInts(startupSize);
+    BulkLoadOptions bulk_options;
+    bulk_options.threads = state.range(0);
+    for (auto _: state) {
+        auto sl = std::make_unique<SkipList<int, int, IntComparator>>(
+                IntComparator{}, entries.begin(), entries.end(), SkipListOptions{}, bulk_options);
+        state.PauseTiming();
+        sl.reset();
+        state.ResumeTiming();
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_Startup_BulkLoad)->ArgName("threads")->Arg(1)->Arg(4)
+        ->Unit(benchmark::kMillisecond)->Iterations(1)->UseRealTime();
+
+// 超过末级缓存的大表上的批量点查：逐个 get 对照 multi_get，参数为每批键数
+SkipList<int, int, IntComparator> &LargeIntSkipList() {
+    static auto sl = [] {
+        auto entries = MakeSortedInts(startupSize);
+        return std::make_unique<SkipList<int, int, IntComparator>>(IntComparator{}, entries.begin(), entries.end());
+    }();
+    return *sl;
+}
+
+std::vector<int> MakeRandomInts(int n, std::mt19937 &gen) {
+    std::vector<int> keys(n);
+    for (auto &key: keys) {
+        key = static_cast<int>(gen() % startupSize);
+    }
+    return keys;
+}
+
+void BenchmarkSkipList_Get_Sequential(benchmark::State &state) {
+    auto &sl = LargeIntSkipList();
+    std::mt19937 gen(0);
+    for (auto _: state) {
+        state.PauseTiming();
+        auto keys = MakeRandomInts(state.range(0), gen);
+        state.ResumeTiming();
+        for (int key: keys) {
+            benchmark::DoNotOptimize(sl.get(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BenchmarkSkipList_Get_Sequential)->Arg(32)->Arg(256);
+
+void BenchmarkSkipList_MultiGet(benchmark::State &state) {
+    auto &sl = LargeIntSkipList();
+    std::mt19937 gen(0);
+    std::vector<std::optional<int>> results;
+    for (auto _: state) {
+        state.PauseTiming();
+        auto keys = MakeRandomInts(state.range(0), gen);
+        state.ResumeTiming();
+        sl.multi_get(keys, &results);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BenchmarkSkipList_MultiGet)->Arg(32)->Arg(256);
+
+// 点查中未命中的比例对布隆过滤器的影响：range(0) 为未命中的百分比，
+// range(1) 表示是否开启过滤器（每键 10 位）。表中为偶数，未命中的键取奇数，
+// 与表中的键交错，不开启过滤器时同样要完整地查找一遍
+const int bloomTableSize = 200000;
+
+void BenchmarkSkipList_Get_MissRate(benchmark::State &state) {
+    SkipListOptions options;
+    if (state.range(1) != 0) {
+        options.bloom_expected_keys = bloomTableSize;
+    }
+    std::vector<std::pair<Key, Value>> entries;
+    for (int i = 0; i < bloomTableSize; ++i) {
+        entries.emplace_back(std::to_string(i * 2), "v");
+    }
+    SkipList<Key, Value, Comparator> sl(Comparator(), entries.begin(), entries.end(), options);
+    std::mt19937 gen(0);
+    std::vector<Key> keys(4096);
+    for (auto &key: keys) {
+        bool miss = static_cast<int>(gen() % 100) < state.range(0);
+        key = std::to_string(gen() % bloomTableSize * 2 + miss);
+    }
+    size_t i = 0;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(sl.contains(keys[i++ % keys.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["filter_bytes"] = sl.get_filter_memory_usage();
+}
+
+BENCHMARK(BenchmarkSkipList_Get_MissRate)->ArgNames({"miss", "bloom"})
+        ->ArgsProduct({{0, 50, 99}, {0, 1}});
+
+// 多路归并：range(0) 张各 100 万条的表，第 j 张表存放 i * 16 + j，
+// 各表的键相互交错，每前进一步都要换一个来源。
+// 败者树（MergingIterator）对照分片迭代器的二叉堆归并
+const int mergeListSize = 1000000;
+const int maxMergeLists = 16;
+
+std::vector<std::unique_ptr<SkipList<int, int, IntComparator>>> &MergeLists() {
+    static auto lists = [] {
+        std::vector<std::unique_ptr<SkipList<int, int, IntComparator>>> lists;
+        SkipListOptions options;
+        options.use_arena = true;
+        for (int j = 0; j < maxMergeLists; ++j) {
+            std::vector<std::pair<int, int>> entries;
+            entries.reserve(mergeListSize);
+            for (int i = 0; i < mergeListSize; ++i) {
+                entries.emplace_back(i * maxMergeLists + j, i);
+            }
+            lists.push_back(std::make_unique<SkipList<int, int, IntComparator>>(
+                    IntComparator{}, entries.begin(), entries.end(), options));
+        }
+        return lists;
+    }();
+    return lists;
+}
+
+std::vector<const SkipList<int, int, IntComparator> *> MergeSources(int n) {
+    std::vector<const SkipList<int, int, IntComparator> *> sources;
+    for (int j = 0; j < n; ++j) {
+        sources.push_back(MergeLists()[j].get());
+    }
+    return sources;
+}
+
+void BenchmarkMergingIterator_Next(benchmark::State &state) {
+    MergingIterator<int, int, IntComparator> it(MergeSources(state.range(0)), IntComparator{});
+    for (auto _: state) {
+        if (it.is_end()) {
+            state.PauseTiming();
+            it.seek_to_first();
+            state.ResumeTiming();
+        }
+        benchmark::DoNotOptimize(it.get_key());
+        ++it;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BenchmarkMergingIterator_Next)->ArgName("lists")->Arg(2)->Arg(4)->Arg(8)->Arg(16);
+
+void BenchmarkMergingIterator_HeapNext(benchmark::State &state) {
+    IntComparator cmp;
+    auto make = [&] {
+        std::vector<SkipListIterator<int, int>> cursors;
+        for (auto list: MergeSources(state.range(0))) {
+            cursors.push_back(list->begin());
+        }
+        return ShardedSkipListIterator<int, int, IntComparator>(std::move(cursors), &cmp, false);
+    };
+    auto it = make();
+    for (auto _: state) {
+        if (it.is_end()) {
+            state.PauseTiming();
+            it = make();
+            state.ResumeTiming();
+        }
+        benchmark::DoNotOptimize(it.get_key());
+        ++it;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BenchmarkMergingIterator_HeapNext)->ArgName("lists")->Arg(2)->Arg(4)->Arg(8)->Arg(16);
+
+void BenchmarkMergingIterator_Seek(benchmark::State &state) {
+    MergingIterator<int, int, IntComparator> it(MergeSources(state.range(0)), IntComparator{});
+    std::mt19937 gen(0);
+    std::vector<int> keys(1 << 16);
+    for (auto &key: keys) {
+        key = static_cast<int>(gen() % (mergeListSize * maxMergeLists));
+    }
+    size_t i = 0;
+    for (auto _: state) {
+        it.seek(keys[i++ % keys.size()]);
+        benchmark::DoNotOptimize(it.get_key());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BenchmarkMergingIterator_Seek)->ArgName("lists")->Arg(2)->Arg(4)->Arg(8)->Arg(16);
+
+// 按位置访问 100 万条的表：range(0) 表示是否开启 indexable，
+// 未开启时 rank/seek_to_index 沿第 0 层逐个计数
+const int indexableSize = 1000000;
+
+std::unique_ptr<SkipList<int, int, IntComparator>> MakeIndexableSkipList(bool indexable) {
+    SkipListOptions options;
+    options.indexable = indexable;
+    std::vector<std::pair<int, int>> entries;
+    entries.reserve(indexableSize);
+    for (int i = 0; i < indexableSize; ++i) {
+        entries.emplace_back(i * 2, i);
+    }
+    return std::make_unique<SkipList<int, int, IntComparator>>(IntComparator{}, entries.begin(), entries.end(),
+                                                               options);
+}
+
+// 分页：随机取一页的起点，定位后顺序读 100 条
+void BenchmarkSkipList_Page_SeekToIndex(benchmark::State &state) {
+    auto sl = MakeIndexableSkipList(state.range(0) != 0);
+    std::mt19937 gen(0);
+    for (auto _: state) {
+        auto it = sl->seek_to_index(gen() % (indexableSize - 100));
+        for (int i = 0; i < 100; ++i, ++it) {
+            benchmark::DoNotOptimize(it.get_value());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["span_bytes"] = sl->get_span_memory_usage();
+}
+
+BENCHMARK(BenchmarkSkipList_Page_SeekToIndex)->ArgName("indexable")->Arg(0)->Arg(1);
+
+void BenchmarkSkipList_Rank(benchmark::State &state) {
+    auto sl = MakeIndexableSkipList(state.range(0) != 0);
+    std::mt19937 gen(0);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(sl->rank(static_cast<int>(gen() % (indexableSize * 2))));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BenchmarkSkipList_Rank)->ArgName("indexable")->Arg(0)->Arg(1);
+
+// 维护跨度的写入开销：在 100 万条的表中随机插入新键（奇数）
+void BenchmarkSkipList_Insert_Indexable(benchmark::State &state) {
+    auto sl = MakeIndexableSkipList(state.range(0) != 0);
+    std::mt19937 gen(0);
+    for (auto _: state) {
+        sl->insert(static_cast<int>(gen() % indexableSize) * 2 + 1, 0);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BenchmarkSkipList_Insert_Indexable)->ArgName("indexable")->Arg(0)->Arg(1);
+
+// 大表上随机点查的延迟：range(0) 为表的大小，range(1) 表示是否开启哈希索引。
+// 不开启时每次查找自顶向下经过约 log2(n) 个节点，几乎每个都是缓存缺失；
+// 开启后一次哈希探测，再读一次节点比较键。counter 为每个键的索引开销
+void BenchmarkSkipList_Get_HashIndex(benchmark::State &state) {
+    const int n = state.range(0);
+    SkipListOptions options;
+    options.hash_index = state.range(1) != 0;
+    std::vector<std::pair<int, int>> entries;
+    for (int i = 0; i < n; ++i) {
+        entries.emplace_back(i, i);
+    }
+    SkipList<int, int, IntComparator> sl(IntComparator{}, entries.begin(), entries.end(), options);
+    std::mt19937 gen(0);
+    std::vector<int> keys(1 << 16);
+    for (auto &key: keys) {
+        key = static_cast<int>(gen() % n);
+    }
+    size_t i = 0;
+    for (auto _: state) {
+        benchmark::DoNotOptimize(sl.get(keys[i++ % keys.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["index_bytes_per_key"] = static_cast<double>(sl.get_index_memory_usage()) / n;
+}
+
+BENCHMARK(BenchmarkSkipList_Get_HashIndex)->ArgNames({"n", "index"})
+        ->ArgsProduct({{100000, 4000000}, {0, 1}});
+
+// 长键上的查找：键为 公共前缀 + 8 位编号 + 长后缀，后缀使键超出短字符串优化，
+// 比较完整的键需要读取堆上的缓冲区。range(0) 为公共前缀长度：为 0 时
+// 内联前缀就能区分绝大多数节点，为 16 时前缀全部相同，总要退回比较器；
+// range(1) 表示是否开启 inline_key_prefix
+const int longKeyCount = 1000000;
+
+std::string MakeLongKey(int shared, int id) {
+    char digits[16];
+    std::snprintf(digits, sizeof(digits), "%08d", id);
+    return std::string(shared, 'p') + digits + "/objects/0123456789abcdef0123456789abcdef";
+}
+
+void BenchmarkSkipList_Find_LongKey(benchmark::State &state) {
+    const int shared = state.range(0);
+    SkipListOptions options;
+    options.inline_key_prefix = state.range(1) != 0;
+    std::vector<std::pair<Key, Value>> entries;
+    for (int i = 0; i < longKeyCount; ++i) {
+        entries.emplace_back(MakeLongKey(shared, i), "v");
+    }
+    SkipList<Key, Value, Comparator> sl(Comparator(), entries.begin(), entries.end(), options);
+    std::mt19937 gen(0);
+    for (auto _: state) {
+        state.PauseTiming();
+        auto key = MakeLongKey(shared, gen() % longKeyCount);
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(sl.contains(key));
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_Find_LongKey)->ArgNames({"shared", "prefix"})
+        ->Args({0, 0})->Args({0, 1})->Args({16, 0})->Args({16, 1});
+
 void BenchmarkMapSkipList_Find(benchmark::State &state) {
     auto sl = MakeSkipListN<std::string, std::string, Comparator>(benchInitSize);
     for (auto _: state) {
@@ -94,6 +659,248 @@ void BenchmarkMapSkipList_Find(benchmark::State &state) {
 
 BENCHMARK(BenchmarkMapSkipList_Find);
 
+// 单写多读：后台一个写线程持续插入和删除，benchmark 线程作为读者无锁查找
+static std::unique_ptr<SkipList<Key, Value, Comparator>> g_swmr_list;
+static std::atomic<bool> g_swmr_stop{false};
+static std::thread g_swmr_writer;
+
+void BenchmarkMapSkipList_Find_ConcurrentReaders(benchmark::State &state) {
+    if (state.thread_index() == 0) {
+        SkipListOptions options;
+        options.concurrent_readers = true;
+        g_swmr_list = MakeSkipListN<std::string, std::string, Comparator>(benchInitSize, options);
+        g_swmr_stop = false;
+        g_swmr_writer = std::thread([] {
+            for (int i = 0; !g_swmr_stop; i = (i + 1) % benchInitSize) {
+                auto key = std::to_string(benchInitSize + i);
+                g_swmr_list->insert(key, key);
+                g_swmr_list->erase(key);
+            }
+        });
+    }
+    std::mt19937 gen(state.thread_index());
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            auto v = g_swmr_list->get(std::to_string(gen() % benchInitSize));
+            (void) v;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * benchBatchSize);
+    if (state.thread_index() == 0) {
+        g_swmr_stop = true;
+        g_swmr_writer.join();
+        state.counters["peak_retired_bytes"] = static_cast<double>(g_swmr_list->get_peak_retired_size());
+        g_swmr_list.reset();
+    }
+}
+
+BENCHMARK(BenchmarkMapSkipList_Find_ConcurrentReaders)->ThreadRange(1, 16)->UseRealTime();
+
+SkipListOptions ConcurrentReadersOptions() {
+    SkipListOptions options;
+    options.concurrent_readers = true;
+    return options;
+}
+
+// 单线程下读者登记 epoch 的开销，对照 BenchmarkMapSkipList_Find
+void BenchmarkMapSkipList_Find_Epoch(benchmark::State &state) {
+    auto sl = MakeSkipListN<std::string, std::string, Comparator>(benchInitSize, ConcurrentReadersOptions());
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            auto v = sl->get(std::to_string(i));
+            (void) v;
+        }
+    }
+}
+
+BENCHMARK(BenchmarkMapSkipList_Find_Epoch);
+
+// 写者退休节点并周期性回收的开销，对照 BenchmarkSkipList_Erase
+void BenchmarkSkipList_Erase_Epoch(benchmark::State &state) {
+    auto start = benchInitSize;
+    auto sl = MakeSkipListN<std::string, std::string, Comparator>(start, ConcurrentReadersOptions());
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            sl->erase(std::to_string(start - i));
+        }
+        start -= benchBatchSize;
+    }
+    state.counters["peak_retired_bytes"] = static_cast<double>(sl->get_peak_retired_size());
+}
+
+BENCHMARK(BenchmarkSkipList_Erase_Epoch);
+
+// 从随机位置开始的短范围扫描：一次查找定位起点，再沿第 0 层前进
+void BenchmarkSkipList_Scan(benchmark::State &state) {
+    auto sl = MakeSkipListN<std::string, std::string, Comparator>(benchInitSize);
+    std::mt19937 gen(0);
+    const int scan_length = state.range(0);
+    for (auto _: state) {
+        int count = 0;
+        auto start = std::to_string(gen() % benchInitSize);
+        for (auto it = sl->seek(start); !it.is_end() && count < scan_length; ++it) {
+            benchmark::DoNotOptimize(it.get_value());
+            ++count;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * scan_length);
+}
+
+BENCHMARK(BenchmarkSkipList_Scan)->Arg(10)->Arg(100);
+
+// 二级索引式的组合键 "group:id" 上的前缀扫描
+std::unique_ptr<SkipList<Key, Value, Comparator>> MakeCompositeSkipList(int groups, int per_group) {
+    auto sl = std::make_unique<SkipList<Key, Value, Comparator>>(Comparator());
+    for (int g = 0; g < groups; ++g) {
+        for (int i = 0; i < per_group; ++i) {
+            sl->insert("group" + std::to_string(g) + ":" + std::to_string(i), std::to_string(i));
+        }
+    }
+    return sl;
+}
+
+void BenchmarkSkipList_PrefixScan(benchmark::State &state) {
+    const int groups = 100;
+    auto sl = MakeCompositeSkipList(groups, benchInitSize / groups);
+    std::mt19937 gen(0);
+    for (auto _: state) {
+        auto prefix = "group" + std::to_string(gen() % groups) + ":";
+        int count = 0;
+        for (auto it = sl->begin_preffix(prefix), end = sl->end_preffix(prefix); it != end; ++it) {
+            ++count;
+        }
+        benchmark::DoNotOptimize(count);
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_PrefixScan);
+
+// 对照组：全表遍历并逐个过滤前缀
+void BenchmarkSkipList_PrefixScan_Linear(benchmark::State &state) {
+    const int groups = 100;
+    auto sl = MakeCompositeSkipList(groups, benchInitSize / groups);
+    std::mt19937 gen(0);
+    for (auto _: state) {
+        auto prefix = "group" + std::to_string(gen() % groups) + ":";
+        int count = 0;
+        for (auto it = sl->begin(); it != sl->end(); ++it) {
+            if (it.get_key().compare(0, prefix.size(), prefix) == 0) {
+                ++count;
+            }
+        }
+        benchmark::DoNotOptimize(count);
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_PrefixScan_Linear);
+
+// 大值查找：get 每次复制整个值，get_with 只把引用交给回调
+std::unique_ptr<SkipList<Key, Value, Comparator>> MakeLargeValueSkipList(size_t value_size) {
+    auto sl = std::make_unique<SkipList<Key, Value, Comparator>>(Comparator());
+    // 条目数取 benchInitSize 的十分之一，控制 64 KB 值时的总内存
+    for (int i = 0; i < benchInitSize / 10; ++i) {
+        sl->insert(std::to_string(i), std::string(value_size, 'v'));
+    }
+    return sl;
+}
+
+void BenchmarkSkipList_Get_LargeValue(benchmark::State &state) {
+    auto sl = MakeLargeValueSkipList(state.range(0));
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            auto v = sl->get(std::to_string(i));
+            benchmark::DoNotOptimize(v);
+        }
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_Get_LargeValue)->Arg(64)->Arg(4096)->Arg(65536);
+
+void BenchmarkSkipList_GetWith_LargeValue(benchmark::State &state) {
+    auto sl = MakeLargeValueSkipList(state.range(0));
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            size_t size = 0;
+            sl->get_with(std::to_string(i), [&](const Value &value) { size = value.size(); });
+            benchmark::DoNotOptimize(size);
+        }
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_GetWith_LargeValue)->Arg(64)->Arg(4096)->Arg(65536);
+
+// 透明比较器：std::string_view 可以直接与 std::string 键比较
+struct TransparentComparator {
+    using is_transparent = void;
+
+    int operator()(std::string_view a, std::string_view b) const {
+        return a.compare(b);
+    }
+};
+
+// 模拟 RPC 请求缓冲区：所有键首尾相连，查找时取其中的切片
+struct KeyBuffer {
+    std::string data;
+    std::vector<std::string_view> keys;
+
+    explicit KeyBuffer(int n) {
+        std::vector<size_t> offsets;
+        for (int i = 0; i < n; ++i) {
+            offsets.push_back(data.size());
+            // 加长前缀，使临时 std::string 超出短字符串优化的容量
+            data += "user:profile:" + std::to_string(i);
+        }
+        offsets.push_back(data.size());
+        for (int i = 0; i < n; ++i) {
+            keys.emplace_back(data.data() + offsets[i], offsets[i + 1] - offsets[i]);
+        }
+    }
+};
+
+std::unique_ptr<SkipList<Key, Value, TransparentComparator>> MakeTransparentSkipList(const KeyBuffer &buffer) {
+    auto sl = std::make_unique<SkipList<Key, Value, TransparentComparator>>(TransparentComparator());
+    for (auto key: buffer.keys) {
+        sl->insert(std::string(key), std::string(key));
+    }
+    return sl;
+}
+
+// 对照组：每次查找先把切片转换成临时 std::string
+void BenchmarkSkipList_Contains_StringKey(benchmark::State &state) {
+    KeyBuffer buffer(benchInitSize);
+    auto sl = MakeTransparentSkipList(buffer);
+    std::mt19937 gen(0);
+    AllocationCounting counting;
+    auto allocs = g_total_allocs.load();
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            benchmark::DoNotOptimize(sl->contains(std::string(buffer.keys[gen() % benchInitSize])));
+        }
+    }
+    state.counters["allocs_per_lookup"] =
+            static_cast<double>(g_total_allocs.load() - allocs) / (state.iterations() * benchBatchSize);
+}
+
+BENCHMARK(BenchmarkSkipList_Contains_StringKey);
+
+// 直接用切片查找，不构造 std::string
+void BenchmarkSkipList_Contains_StringViewKey(benchmark::State &state) {
+    KeyBuffer buffer(benchInitSize);
+    auto sl = MakeTransparentSkipList(buffer);
+    std::mt19937 gen(0);
+    AllocationCounting counting;
+    auto allocs = g_total_allocs.load();
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            benchmark::DoNotOptimize(sl->contains(buffer.keys[gen() % benchInitSize]));
+        }
+    }
+    state.counters["allocs_per_lookup"] =
+            static_cast<double>(g_total_allocs.load() - allocs) / (state.iterations() * benchBatchSize);
+}
+
+BENCHMARK(BenchmarkSkipList_Contains_StringViewKey);
+
 void BenchmarkMap_Insert(benchmark::State &state) {
     auto start = benchInitSize;
     auto m = MakeMapN(benchInitSize);
@@ -145,4 +952,412 @@ void BenchmarkMap_Find(benchmark::State &state) {
 
 BENCHMARK(BenchmarkMap_Find);
 
+// 旧的节点布局：每个节点都持有一个 max_level 长度的 std::vector 作为塔
+struct VectorTowerNode {
+    Key key_;
+    Value value_;
+    std::vector<VectorTowerNode *> forward_;
+
+    VectorTowerNode(Key key, Value value, int level)
+        : key_(std::move(key)), value_(std::move(value)), forward_(level, nullptr) {}
+};
+
+void BenchmarkSkipList_MemoryPerEntry(benchmark::State &state) {
+    AllocationCounting counting;
+    for (auto _: state) {
+        auto bytes = g_live_bytes.load();
+        auto allocs = g_live_allocs.load();
+        auto sl = MakeSkipListN<std::string, std::string, Comparator>(benchInitSize);
+        state.counters["bytes_per_entry"] =
+                static_cast<double>(g_live_bytes.load() - bytes) / benchInitSize;
+        state.counters["allocs_per_entry"] =
+                static_cast<double>(g_live_allocs.load() - allocs) / benchInitSize;
+        // get_memory_usage 的统计值，与上面实测的堆占用对照
+        state.counters["reported_bytes_per_entry"] =
+                static_cast<double>(sl->get_memory_usage()) / benchInitSize;
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_MemoryPerEntry)->Unit(benchmark::kMillisecond);
+
+// 对照组：按旧布局分配同样数量的节点，塔高固定为 max_level
+void BenchmarkSkipList_MemoryPerEntry_VectorTower(benchmark::State &state) {
+    const int max_level = 16;
+    AllocationCounting counting;
+    for (auto _: state) {
+        auto bytes = g_live_bytes.load();
+        auto allocs = g_live_allocs.load();
+        std::vector<std::unique_ptr<VectorTowerNode>> nodes;
+        nodes.reserve(benchInitSize);
+        auto reserved_bytes = g_live_bytes.load() - bytes;
+        for (int i = 0; i < benchInitSize; ++i) {
+            nodes.emplace_back(std::make_unique<VectorTowerNode>(
+                    std::to_string(i), std::to_string(i), max_level));
+        }
+        state.counters["bytes_per_entry"] =
+                static_cast<double>(g_live_bytes.load() - bytes - reserved_bytes) / benchInitSize;
+        state.counters["allocs_per_entry"] =
+                static_cast<double>(g_live_allocs.load() - allocs - 1) / benchInitSize;
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_MemoryPerEntry_VectorTower)->Unit(benchmark::kMillisecond);
+
+// 元数据式的小键值（键 20 字节、值 24 字节，超过 std::string 的短字符串容量）：
+// std::string 每个条目三次分配，string_view 内联存储只有一次
+std::pair<std::string, std::string> MakeSmallEntry(int i) {
+    char key[32];
+    std::snprintf(key, sizeof(key), "meta/inode/%09d", i);
+    return {key, std::string(24, 'v')};
+}
+
+template<typename K, typename V, class Cmp>
+void BenchmarkSkipList_SmallEntries(benchmark::State &state) {
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (int i = 0; i < benchInitSize; ++i) {
+        entries.push_back(MakeSmallEntry(i));
+    }
+    AllocationCounting counting;
+    for (auto _: state) {
+        auto bytes = g_live_bytes.load();
+        auto allocs = g_live_allocs.load();
+        SkipList<K, V, Cmp> sl(Cmp{});
+        for (auto &[key, value]: entries) {
+            sl.insert(K(key), V(value));
+        }
+        state.counters["bytes_per_entry"] =
+                static_cast<double>(g_live_bytes.load() - bytes) / benchInitSize;
+        state.counters["allocs_per_entry"] =
+                static_cast<double>(g_live_allocs.load() - allocs) / benchInitSize;
+        // 随机点查整张表一遍
+        std::mt19937 gen(0);
+        for (int i = 0; i < benchInitSize; ++i) {
+            benchmark::DoNotOptimize(sl.contains(std::string_view(entries[gen() % benchInitSize].first)));
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(BenchmarkSkipList_SmallEntries, std::string, std::string, TransparentComparator)
+        ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BenchmarkSkipList_SmallEntries, std::string_view, std::string_view, TransparentComparator)
+        ->Unit(benchmark::kMillisecond);
+
+SkipListOptions ArenaOptions() {
+    SkipListOptions options;
+    options.use_arena = true;
+    return options;
+}
+
+void BenchmarkSkipList_Insert_Arena(benchmark::State &state) {
+    auto start = benchInitSize;
+    auto sl = MakeSkipListN<std::string, std::string, Comparator>(start, ArenaOptions());
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            sl->insert(std::to_string(start + i), std::to_string(i));
+        }
+        start += benchBatchSize;
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_Insert_Arena);
+
+void BenchmarkSkipList_Erase_Arena(benchmark::State &state) {
+    auto start = benchInitSize;
+    auto sl = MakeSkipListN<std::string, std::string, Comparator>(start, ArenaOptions());
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            sl->erase(std::to_string(start - i));
+        }
+        start -= benchBatchSize;
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_Erase_Arena);
+
+void BenchmarkSkipList_Find_Arena(benchmark::State &state) {
+    auto sl = MakeSkipListN<std::string, std::string, Comparator>(benchInitSize, ArenaOptions());
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            auto v = sl->get(std::to_string(i));
+            (void) v;
+        }
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_Find_Arena);
+
+// 整表构建与析构：对比逐节点 new/delete 与 Arena 整体释放
+void BenchmarkSkipList_BuildAndDestroy(benchmark::State &state) {
+    SkipListOptions options;
+    options.use_arena = state.range(0) != 0;
+    for (auto _: state) {
+        auto sl = MakeSkipListN<std::string, std::string, Comparator>(benchInitSize, options);
+        state.counters["arena_bytes"] = static_cast<double>(sl->get_arena_usage());
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_BuildAndDestroy)->ArgName("arena")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// 并发写入：每个线程插入随机分布的键
+static ConcurrentSkipList<Key, Value, Comparator> *g_concurrent_list = nullptr;
+
+void BenchmarkConcurrentSkipList_Insert(benchmark::State &state) {
+    if (state.thread_index() == 0) {
+        g_concurrent_list = new ConcurrentSkipList<Key, Value, Comparator>(Comparator());
+    }
+    std::mt19937_64 gen(state.thread_index());
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            g_concurrent_list->insert(std::to_string(gen()), std::to_string(i));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * benchBatchSize);
+    if (state.thread_index() == 0) {
+        delete g_concurrent_list;
+        g_concurrent_list = nullptr;
+    }
+}
+
+BENCHMARK(BenchmarkConcurrentSkipList_Insert)->ThreadRange(1, 16)->UseRealTime();
+
+void BenchmarkConcurrentSkipList_Find(benchmark::State &state) {
+    if (state.thread_index() == 0) {
+        g_concurrent_list = new ConcurrentSkipList<Key, Value, Comparator>(Comparator());
+        for (int i = 0; i < benchInitSize; ++i) {
+            g_concurrent_list->insert(std::to_string(i), std::to_string(i));
+        }
+    }
+    std::mt19937 gen(state.thread_index());
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            auto v = g_concurrent_list->get(std::to_string(gen() % benchInitSize));
+            (void) v;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * benchBatchSize);
+    if (state.thread_index() == 0) {
+        delete g_concurrent_list;
+        g_concurrent_list = nullptr;
+    }
+}
+
+BENCHMARK(BenchmarkConcurrentSkipList_Find)->ThreadRange(1, 16)->UseRealTime();
+
+// 对照组：用一把全局锁保护的 SkipList
+static SkipList<Key, Value, Comparator> *g_locked_list = nullptr;
+static std::mutex g_list_mutex;
+
+void BenchmarkSkipList_Insert_Mutex(benchmark::State &state) {
+    if (state.thread_index() == 0) {
+        g_locked_list = new SkipList<Key, Value, Comparator>(Comparator());
+    }
+    std::mt19937_64 gen(state.thread_index());
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            auto key = std::to_string(gen());
+            std::lock_guard<std::mutex> lock(g_list_mutex);
+            g_locked_list->insert(std::move(key), std::to_string(i));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * benchBatchSize);
+    if (state.thread_index() == 0) {
+        delete g_locked_list;
+        g_locked_list = nullptr;
+    }
+}
+
+BENCHMARK(BenchmarkSkipList_Insert_Mutex)->ThreadRange(1, 16)->UseRealTime();
+
+// 分片跳表：每个分片一把锁，与上面的全局锁对照写吞吐随线程数的变化
+static ShardedSkipList<Key, Value, Comparator> *g_sharded_list = nullptr;
+
+// 从与写入同分布的样本中取分位点作为分割键，使各分片大致均衡
+std::vector<Key> SampleSplitKeys(int shards) {
+    std::mt19937_64 gen(12345);
+    std::vector<Key> sample(shards * 64);
+    for (auto &key: sample) {
+        key = std::to_string(gen());
+    }
+    std::sort(sample.begin(), sample.end());
+    std::vector<Key> splits;
+    for (int i = 1; i < shards; ++i) {
+        splits.push_back(sample[i * 64]);
+    }
+    return splits;
+}
+
+void BenchmarkShardedSkipList_Insert(benchmark::State &state) {
+    if (state.thread_index() == 0) {
+        int shards = static_cast<int>(state.range(1));
+        if (state.range(0) == 0) {
+            g_sharded_list = new ShardedSkipList<Key, Value, Comparator>(Comparator(), shards);
+        } else {
+            g_sharded_list = new ShardedSkipList<Key, Value, Comparator>(Comparator(), SampleSplitKeys(shards));
+        }
+    }
+    std::mt19937_64 gen(state.thread_index());
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            g_sharded_list->insert(std::to_string(gen()), std::to_string(i));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * benchBatchSize);
+    if (state.thread_index() == 0) {
+        delete g_sharded_list;
+        g_sharded_list = nullptr;
+    }
+}
+
+BENCHMARK(BenchmarkShardedSkipList_Insert)->ArgNames({"range", "shards"})
+        ->ArgsProduct({{0, 1}, {64}})->ThreadRange(1, 64)->UseRealTime();
+
+// MemTable 写入吞吐，按 range(0) KB 的阈值不断冻结换表，
+// 后台线程遍历被冻结的表模拟刷盘
+using BenchMemTable = MemTable<Key, Value, Comparator>;
+
+void CountFlushedEntries(const BenchMemTable::Table &table) {
+    size_t entries = 0;
+    for (auto it = table.begin(); !it.is_end(); ++it) {
+        ++entries;
+    }
+    benchmark::DoNotOptimize(entries);
+}
+
+void BenchmarkMemTable_Insert(benchmark::State &state) {
+    MemTableOptions options;
+    options.flush_threshold = state.range(0) << 10;
+    BenchMemTable memtable(Comparator(), options, CountFlushedEntries);
+    std::mt19937_64 gen(0);
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            memtable.insert(std::to_string(gen()), std::to_string(i));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * benchBatchSize);
+    state.counters["rotations"] = memtable.get_flushed_count() + memtable.get_immutable_count();
+}
+
+BENCHMARK(BenchmarkMemTable_Insert)->ArgName("threshold_kb")->Arg(64)->Arg(1024)->Arg(1 << 20);
+
+// 线程 0 持续写入并触发换表，其余线程同时点查，统计读吞吐
+static BenchMemTable *g_memtable = nullptr;
+
+void BenchmarkMemTable_GetDuringRotation(benchmark::State &state) {
+    if (state.thread_index() == 0) {
+        MemTableOptions options;
+        options.flush_threshold = 64 << 10;
+        g_memtable = new BenchMemTable(Comparator(), options, CountFlushedEntries);
+        for (int i = 0; i < benchInitSize; ++i) {
+            g_memtable->insert(std::to_string(i), std::to_string(i));
+        }
+    }
+    std::mt19937 gen(state.thread_index());
+    int next = benchInitSize;
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            if (state.thread_index() == 0) {
+                g_memtable->insert(std::to_string(next), std::to_string(next));
+                ++next;
+            } else {
+                auto v = g_memtable->get(std::to_string(gen() % benchInitSize));
+                benchmark::DoNotOptimize(v);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * benchBatchSize);
+    if (state.thread_index() == 0) {
+        delete g_memtable;
+        g_memtable = nullptr;
+    }
+}
+
+BENCHMARK(BenchmarkMemTable_GetDuringRotation)->ThreadRange(2, 16)->UseRealTime();
+
+// 预写日志的提交延迟与吞吐：每次迭代提交一条记录，单次迭代的实际耗时
+// 即提交延迟。日志放在当前目录（本地磁盘），range(0) 为 WalSyncPolicy
+static WriteAheadLog *g_wal = nullptr;
+static const char *kBenchWalPath = "skiplist_benchmark.wal";
+
+void BenchmarkWal_Commit(benchmark::State &state) {
+    if (state.thread_index() == 0) {
+        std::remove(kBenchWalPath);
+        WalOptions options;
+        options.sync = static_cast<WalSyncPolicy>(state.range(0));
+        g_wal = new WriteAheadLog(kBenchWalPath, options);
+    }
+    std::mt19937_64 gen(state.thread_index());
+    std::string value(100, 'v');
+    for (auto _: state) {
+        g_wal->append(WriteAheadLog::RecordType::kInsert, std::to_string(gen()), value);
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        state.counters["records_per_group"] =
+                static_cast<double>(g_wal->get_record_count()) / std::max<uint64_t>(g_wal->get_group_count(), 1);
+        state.counters["syncs"] = g_wal->get_sync_count();
+        delete g_wal;
+        g_wal = nullptr;
+        std::remove(kBenchWalPath);
+    }
+}
+
+BENCHMARK(BenchmarkWal_Commit)->ArgName("policy")
+        ->Arg(static_cast<int>(WalSyncPolicy::kEveryWrite))
+        ->Arg(static_cast<int>(WalSyncPolicy::kInterval))
+        ->Arg(static_cast<int>(WalSyncPolicy::kNone))
+        ->ThreadRange(1, 16)->UseRealTime();
+
+// 把 64 MB 的内存表写成 SST 的吞吐，文件放在当前目录（本地磁盘）
+void BenchmarkSst_Flush64MB(benchmark::State &state) {
+    const size_t target = 64 << 20;
+    SkipList<Key, Value, Comparator> list{Comparator()};
+    std::mt19937_64 gen(0);
+    std::string value(100, 'v');
+    while (list.get_size() < target) {
+        list.insert(fmt::format("{:016x}", gen()), value);
+    }
+    const char *path = "skiplist_benchmark.sst";
+    uint64_t file_size = 0;
+    for (auto _: state) {
+        file_size = write_sst(list, path);
+    }
+    state.SetBytesProcessed(state.iterations() * list.get_size());
+    state.counters["file_mb"] = static_cast<double>(file_size) / (1 << 20);
+    std::remove(path);
+}
+
+BENCHMARK(BenchmarkSst_Flush64MB)->Unit(benchmark::kMillisecond)->Iterations(5);
+
+// 多版本下的快照点查：每个键 range(0) 个版本，range(1) 为 1 时在
+// 第一轮写入后的快照上读（需越过所有新版本），为 0 时读最新快照。
+// 内部键按序列号降序，查找直接定位到快照下可见的版本，新旧快照代价相同，
+// 版本数只通过表的大小影响查找
+void BenchmarkVersionedSkipList_SnapshotGet(benchmark::State &state) {
+    VersionedSkipList<Key, Value, Comparator> list{Comparator()};
+    const int versions = static_cast<int>(state.range(0));
+    auto snapshot = list.get_snapshot();
+    for (int v = 0; v < versions; ++v) {
+        for (int i = 0; i < benchInitSize; ++i) {
+            list.insert(std::to_string(i), std::to_string(v));
+        }
+        if (v == 0 && state.range(1) == 1) {
+            snapshot = list.get_snapshot();
+        }
+    }
+    if (state.range(1) == 0) {
+        snapshot = list.get_snapshot();
+    }
+    std::mt19937 gen(0);
+    for (auto _: state) {
+        for (auto i = 0; i < benchBatchSize; i++) {
+            auto v = list.get(std::to_string(gen() % benchInitSize), snapshot);
+            benchmark::DoNotOptimize(v);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * benchBatchSize);
+}
+
+BENCHMARK(BenchmarkVersionedSkipList_SnapshotGet)->ArgNames({"versions", "old_snapshot"})
+        ->ArgsProduct({{1, 16, 64}, {0, 1}});
+
 BENCHMARK_MAIN();
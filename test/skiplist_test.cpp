@@ -1,15 +1,40 @@
 #include "skiplist.h"
 #include "skiplist.cpp"
+#include "concurrent_skiplist.h"
+#include "concurrent_skiplist.cpp"
+#include "sharded_skiplist.h"
+#include "sharded_skiplist.cpp"
+#include "merging_iterator.h"
+#include "merging_iterator.cpp"
+#include "memtable.h"
+#include "memtable.cpp"
+#include "wal.h"
+#include "durable_skiplist.h"
+#include "durable_skiplist.cpp"
+#include "sst.h"
+#include "coding.h"
+#include "versioned_skiplist.h"
+#include "versioned_skiplist.cpp"
+
+#include <sys/resource.h>
 
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <future>
 #include <gtest/gtest.h>
 #include <iomanip>
 #include <latch>
+#include <limits>
+#include <map>
 #include <random>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <unordered_set>
 #include <utility>
@@ -103,15 +128,583 @@ TEST(SkipListTest, Iterator) {
     skipList.insert("key3", "value3");
 
     // 测试迭代器
-    // std::vector<std::pair<std::string, std::string> > result;
-    // for (auto it = skipList.begin(); it != skipList.end(); ++it) {
-    //     result.push_back(*it);
-    // }
+    std::vector<std::pair<std::string, std::string> > result;
+    for (auto it = skipList.begin(); it != skipList.end(); ++it) {
+        result.push_back(*it);
+    }
+
+    EXPECT_EQ(result.size(), 3);
+    EXPECT_EQ(result[0].first, "key1");
+    EXPECT_EQ(result[1].first, "key2");
+    EXPECT_EQ(result[2].first, "key3");
+}
+
+// 测试 seek / lower_bound / upper_bound
+TEST(SkipListTest, Seek) {
+    Comparator cmp;
+    SkipList<Key, Value, Comparator> skipList(cmp);
+    EXPECT_TRUE(skipList.begin().is_end());
+    EXPECT_TRUE(skipList.seek("key").is_end());
+
+    for (int i = 0; i < 100; i += 2) {
+        std::ostringstream oss;
+        oss << "key" << std::setw(3) << std::setfill('0') << i;
+        skipList.insert(oss.str(), std::to_string(i));
+    }
+
+    EXPECT_EQ(skipList.seek("key010").get_key(), "key010");
+    EXPECT_EQ(skipList.seek("key011").get_key(), "key012");
+    EXPECT_EQ(skipList.lower_bound("key010").get_value(), "10");
+    EXPECT_EQ(skipList.upper_bound("key010").get_key(), "key012");
+    EXPECT_EQ(skipList.lower_bound("a"), skipList.begin());
+    EXPECT_TRUE(skipList.lower_bound("key099").is_end());
+    EXPECT_TRUE(skipList.upper_bound("key098") == skipList.end());
+
+    auto it = skipList.seek("key090");
+    EXPECT_EQ((it++).get_key(), "key090");
+    EXPECT_EQ(it.get_key(), "key092");
+}
+
+// 测试范围扫描
+TEST(SkipListTest, Scan) {
+    IntComparator cmp;
+    SkipList<int, int, IntComparator> skipList(cmp);
+    for (int i = 0; i < 1000; ++i) {
+        skipList.insert(i, i * 10);
+    }
+    skipList.erase(105);
+
+    std::vector<int> keys;
+    skipList.scan(100, 110, [&](const int &key, const int &value) {
+        EXPECT_EQ(value, key * 10);
+        keys.push_back(key);
+    });
+    EXPECT_EQ(keys, (std::vector<int>{100, 101, 102, 103, 104, 106, 107, 108, 109}));
+
+    // 回调返回 false 时提前结束
+    keys.clear();
+    skipList.scan(500, 1000, [&](const int &key, const int &) {
+        keys.push_back(key);
+        return keys.size() < 3;
+    });
+    EXPECT_EQ(keys, (std::vector<int>{500, 501, 502}));
+
+    // 空区间
+    keys.clear();
+    skipList.scan(2000, 3000, [&](const int &key, const int &) { keys.push_back(key); });
+    EXPECT_TRUE(keys.empty());
+}
+
+// 测试键值类型不同时 get 返回值类型，以及零拷贝查找
+TEST(SkipListTest, GetValueType) {
+    Comparator cmp;
+    SkipList<Key, int, Comparator> skipList(cmp);
+    skipList.insert("key1", 1);
+    skipList.insert("key2", 2);
+
+    std::optional<int> result = skipList.get("key2");
+    EXPECT_EQ(result.value(), 2);
+    EXPECT_FALSE(skipList.get("key3").has_value());
+
+    const int *seen = nullptr;
+    EXPECT_TRUE(skipList.get_with("key1", [&](const int &value) { seen = &value; }));
+    ASSERT_NE(seen, nullptr);
+    EXPECT_EQ(*seen, 1);
+    EXPECT_FALSE(skipList.get_with("key3", [&](const int &) { FAIL(); }));
+    EXPECT_TRUE(skipList.contains("key1"));
+    EXPECT_FALSE(skipList.contains("key3"));
+}
+
+// 透明比较器：可以直接用 std::string_view 与 std::string 键比较
+struct TransparentComparator {
+    using is_transparent = void;
+
+    int operator()(std::string_view a, std::string_view b) const {
+        return a.compare(b) < 0 ? -1 : (a == b ? 0 : 1);
+    }
+};
+
+// 测试透明比较器下用 string_view 查找
+TEST(SkipListTest, HeterogeneousLookup) {
+    TransparentComparator cmp;
+    SkipList<Key, int, TransparentComparator> skipList(cmp);
+    for (int i = 0; i < 100; i += 2) {
+        std::ostringstream oss;
+        oss << "key" << std::setw(3) << std::setfill('0') << i;
+        skipList.insert(oss.str(), i);
+    }
+
+    // 在一段更长的缓冲区上取切片查找，不构造 std::string
+    std::string buffer = "key010key011key098";
+    std::string_view key010(buffer.data(), 6);
+    std::string_view key011(buffer.data() + 6, 6);
+    std::string_view key098(buffer.data() + 12, 6);
+    EXPECT_EQ(skipList.get(key010).value(), 10);
+    EXPECT_FALSE(skipList.get(key011).has_value());
+    EXPECT_TRUE(skipList.contains(key098));
+    EXPECT_TRUE(skipList.get_with(key010, [](const int &value) { EXPECT_EQ(value, 10); }));
+    EXPECT_EQ(skipList.seek(key011).get_key(), "key012");
+    EXPECT_EQ(skipList.lower_bound(key010).get_key(), "key010");
+    EXPECT_EQ(skipList.upper_bound(key010).get_key(), "key012");
+
+    skipList.erase(key010);
+    EXPECT_FALSE(skipList.contains(key010));
+    EXPECT_EQ(skipList.get(std::string("key012")).value(), 12);
+    EXPECT_EQ(skipList.get("key014").value(), 14);
+}
+
+// 测试批量查找与逐个 get 结果一致
+TEST(SkipListTest, MultiGet) {
+    IntComparator cmp;
+    SkipList<int, int, IntComparator> skipList(cmp);
+    for (int i = 0; i < 5000; i += 2) {
+        skipList.insert(i, i * 10);
+    }
+    std::mt19937 gen(0);
+    for (int count: {0, 1, 15, 16, 17, 300}) {
+        std::vector<int> keys;
+        for (int i = 0; i < count; ++i) {
+            keys.push_back(static_cast<int>(gen() % 5200) - 100);
+        }
+        std::vector<std::optional<int>> results;
+        skipList.multi_get(keys, &results);
+        ASSERT_EQ(results.size(), keys.size());
+        for (int i = 0; i < count; ++i) {
+            EXPECT_EQ(results[i], skipList.get(keys[i]));
+        }
+    }
+
+    // 需要转换成 Key 的查找键，以及透明比较器下的 string_view
+    Comparator string_cmp;
+    SkipList<Key, Value, Comparator> strings(string_cmp);
+    strings.insert("a", "1");
+    strings.insert("c", "3");
+    std::vector<const char *> names = {"c", "b", "a"};
+    std::vector<std::optional<Value>> values;
+    strings.multi_get(names, &values);
+    EXPECT_EQ(values, (std::vector<std::optional<Value>>{"3", std::nullopt, "1"}));
+
+    SkipList<Key, int, TransparentComparator> views(TransparentComparator{});
+    views.insert("key1", 1);
+    std::vector<std::string_view> view_keys = {"key1", "key2"};
+    std::vector<std::optional<int>> view_values;
+    views.multi_get(view_keys, &view_values);
+    EXPECT_EQ(view_values, (std::vector<std::optional<int>>{1, std::nullopt}));
+}
+
+// 测试布隆过滤器：不漏报，误判率接近按每键位数推算的值；
+// 开启过滤器后各查找接口的结果与不开启时一致
+TEST(SkipListTest, BloomFilter) {
+    EXPECT_NEAR(BloomFilter::bits_per_key_for(0.01), 9.59, 0.01);
+    BloomFilter filter(10000, 10);
+    EXPECT_EQ(filter.memory_usage(), 10000 * 10 / 512 * 64 + 64);
+    for (uint64_t i = 0; i < 10000; ++i) {
+        filter.add(SkipListKeyHash<uint64_t>::hash(i));
+    }
+    int false_positives = 0;
+    for (uint64_t i = 0; i < 10000; ++i) {
+        EXPECT_TRUE(filter.may_contain(SkipListKeyHash<uint64_t>::hash(i)));
+    }
+    for (uint64_t i = 10000; i < 110000; ++i) {
+        false_positives += filter.may_contain(SkipListKeyHash<uint64_t>::hash(i));
+    }
+    EXPECT_LT(false_positives, 2000);  // 约 1%
+
+    // std::string 键与 string_view、const char* 查找键的哈希相同
+    EXPECT_EQ(SkipListKeyHash<Key>::hash("abc"), SkipListKeyHash<std::string_view>::hash("abc"));
+    EXPECT_EQ(SkipListKeyHash<const char *>::hash("abc"), SkipListKeyHash<Key>::hash(Key("abc")));
+
+    for (bool concurrent_readers: {false, true}) {
+        SkipListOptions options;
+        options.concurrent_readers = concurrent_readers;
+        options.bloom_expected_keys = 1000;
+        SkipList<Key, int, TransparentComparator> skipList(TransparentComparator{}, options);
+        EXPECT_GT(skipList.get_filter_memory_usage(), 0);
+        EXPECT_GE(skipList.get_memory_usage(), skipList.get_filter_memory_usage());
+        std::map<Key, int> expected;
+        std::mt19937 gen(0);
+        for (int i = 0; i < 5000; ++i) {
+            auto key = "key" + std::to_string(gen() % 2000);
+            if (gen() % 3 == 0) {
+                skipList.erase(std::string_view(key));
+                expected.erase(key);
+            } else {
+                skipList.insert(key, i);
+                expected[key] = i;
+            }
+        }
+        std::vector<std::string_view> keys;
+        std::vector<Key> names;
+        for (int i = 0; i < 4000; ++i) {
+            names.push_back("key" + std::to_string(i));
+        }
+        for (auto &name: names) {
+            keys.push_back(name);
+            auto it = expected.find(name);
+            EXPECT_EQ(skipList.get(std::string_view(name)),
+                      it == expected.end() ? std::nullopt : std::optional<int>(it->second));
+            EXPECT_EQ(skipList.contains(name.c_str()), it != expected.end());
+        }
+        std::vector<std::optional<int>> results;
+        skipList.multi_get(keys, &results);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            EXPECT_EQ(results[i], skipList.get(keys[i]));
+        }
+    }
+
+    // 批量构建时各线程同时置位
+    SkipListOptions options;
+    options.bloom_expected_keys = 5000;
+    auto entries = std::vector<std::pair<int, int>>();
+    for (int i = 0; i < 5000; ++i) {
+        entries.emplace_back(i * 2, i);
+    }
+    BulkLoadOptions bulk_options;
+    bulk_options.threads = 4;
+    SkipList<int, int, IntComparator> ints(IntComparator(), entries.begin(), entries.end(), options,
+                                           bulk_options);
+    int found = 0;
+    for (int i = 0; i < 10000; ++i) {
+        found += ints.contains(i);
+    }
+    EXPECT_EQ(found, 5000);
+
+    // 不支持哈希的键类型忽略此选项
+    struct Point {
+        int x;
+    };
+    struct PointComparator {
+        int operator()(const Point &a, const Point &b) const { return a.x - b.x; }
+    };
+    SkipList<Point, int, PointComparator> points(PointComparator(), options);
+    points.insert({1}, 1);
+    EXPECT_EQ(points.get_filter_memory_usage(), 0);
+    EXPECT_TRUE(points.contains(Point{1}));
+}
+
+// 测试哈希索引：insert（含覆盖写）和 erase 后点查结果与跳表一致，
+// 墓碑和扩容后仍能找到所有键；扫描不受影响
+TEST(SkipListTest, HashIndex) {
+    for (bool concurrent_readers: {false, true}) {
+        for (size_t bloom_keys: {0, 1000}) {
+            SkipListOptions options;
+            options.concurrent_readers = concurrent_readers;
+            options.hash_index = true;
+            options.bloom_expected_keys = bloom_keys;
+            SkipList<Key, Value, TransparentComparator> skipList(TransparentComparator{}, options);
+            size_t empty_index = skipList.get_index_memory_usage();
+            EXPECT_GT(empty_index, 0);
+            std::map<Key, Value> expected;
+            std::mt19937 gen(0);
+            for (int i = 0; i < 20000; ++i) {
+                auto key = "key" + std::to_string(gen() % 3000);
+                if (gen() % 3 == 0) {
+                    skipList.erase(key);
+                    expected.erase(key);
+                } else {
+                    skipList.insert(key, std::to_string(i));
+                    expected[key] = std::to_string(i);
+                }
+            }
+            EXPECT_GT(skipList.get_index_memory_usage(), empty_index);
+            EXPECT_GE(skipList.get_memory_usage(),
+                      skipList.get_index_memory_usage() + skipList.get_filter_memory_usage());
+            std::vector<std::string_view> keys;
+            std::vector<Key> names;
+            for (int i = 0; i < 3500; ++i) {
+                names.push_back("key" + std::to_string(i));
+            }
+            for (auto &name: names) {
+                keys.push_back(name);
+                auto it = expected.find(name);
+                auto value = it == expected.end() ? std::nullopt : std::optional<Value>(it->second);
+                EXPECT_EQ(skipList.get(name), value);
+                EXPECT_EQ(skipList.get(std::string_view(name)), value);
+                EXPECT_EQ(skipList.contains(name.c_str()), value.has_value());
+            }
+            std::vector<std::optional<Value>> results;
+            skipList.multi_get(keys, &results);
+            for (size_t i = 0; i < keys.size(); ++i) {
+                EXPECT_EQ(results[i], skipList.get(keys[i]));
+            }
+            std::vector<std::pair<Key, Value>> scanned;
+            for (auto it = skipList.begin(); it != skipList.end(); ++it) {
+                scanned.emplace_back(it.get_key(), it.get_value());
+            }
+            EXPECT_EQ(scanned, (std::vector<std::pair<Key, Value>>(expected.begin(), expected.end())));
+        }
+    }
+
+    // 批量构建后建立索引
+    SkipListOptions options;
+    options.hash_index = true;
+    auto entries = std::vector<std::pair<int, int>>();
+    for (int i = 0; i < 5000; ++i) {
+        entries.emplace_back(i * 2, i);
+    }
+    SkipList<int, int, IntComparator> ints(IntComparator(), entries.begin(), entries.end(), options);
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(ints.get(i), i % 2 == 0 ? std::optional<int>(i / 2) : std::nullopt);
+    }
+
+    // 读者通过索引查找，写者同时覆盖写、删除并触发扩容
+    options.concurrent_readers = true;
+    SkipList<int, int, IntComparator> shared(IntComparator(), options);
+    for (int i = 0; i < 1000; ++i) {
+        shared.insert(i, i);
+    }
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!stop.load()) {
+                for (int i = 0; i < 1000; ++i) {
+                    // 前 1000 个键只被覆盖写，值总是键的倍数
+                    auto value = shared.get(i);
+                    ASSERT_TRUE(value.has_value());
+                    ASSERT_TRUE(i == 0 || *value % i == 0);
+                }
+            }
+        });
+    }
+    for (int round = 1; round <= 20; ++round) {
+        for (int i = 0; i < 1000; ++i) {
+            shared.insert(i, i * round);
+        }
+        for (int i = 1000; i < 1000 + round * 500; ++i) {
+            shared.insert(i, i);
+        }
+        for (int i = 1000; i < 1000 + round * 500; ++i) {
+            shared.erase(i);
+        }
+    }
+    stop.store(true);
+    for (auto &reader: readers) {
+        reader.join();
+    }
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(shared.get(i), i * 20);
+    }
+    EXPECT_FALSE(shared.contains(1500));
+}
+
+// 测试按位置访问：随机插入、覆盖写、删除和批量写入之后，rank/at/seek_to_index
+// 与 std::map 中的位置一致；未开启 indexable 时线性计数的结果相同
+TEST(SkipListTest, IndexableRankAndSelect) {
+    for (bool indexable: {true, false}) {
+        for (bool prefix_and_readers: {false, true}) {
+            SkipListOptions options;
+            options.indexable = indexable;
+            options.inline_key_prefix = prefix_and_readers;
+            options.concurrent_readers = prefix_and_readers;
+            SkipList<Key, Value, Comparator> skipList(Comparator(), options);
+            EXPECT_EQ(skipList.get_span_memory_usage() > 0, indexable);
+            EXPECT_FALSE(skipList.at(0).has_value());
+            EXPECT_TRUE(skipList.seek_to_index(SIZE_MAX).is_end());
+            std::map<Key, Value> expected;
+            std::mt19937 gen(indexable);
+            auto check = [&] {
+                std::vector<Key> keys;
+                for (auto &entry: expected) {
+                    keys.push_back(entry.first);
+                }
+                for (size_t i = 0; i < keys.size(); ++i) {
+                    auto entry = skipList.at(i);
+                    ASSERT_TRUE(entry.has_value());
+                    ASSERT_EQ(entry->first, keys[i]);
+                    ASSERT_EQ(entry->second, expected[keys[i]]);
+                    ASSERT_EQ(skipList.rank(keys[i]), i);
+                }
+                EXPECT_FALSE(skipList.at(keys.size()).has_value());
+                EXPECT_TRUE(skipList.seek_to_index(keys.size() + 5).is_end());
+                // index + 1 溢出的边界
+                EXPECT_FALSE(skipList.at(SIZE_MAX).has_value());
+                EXPECT_TRUE(skipList.seek_to_index(SIZE_MAX).is_end());
+                // 不在表中的键的位置为插入点
+                for (int i = 0; i < 50; ++i) {
+                    auto key = std::to_string(gen() % 3000) + "~";
+                    ASSERT_EQ(skipList.rank(key),
+                              std::distance(expected.begin(), expected.lower_bound(key)));
+                }
+                // 分页：定位一次后顺序前进
+                size_t page = keys.size() / 3;
+                auto it = skipList.seek_to_index(page);
+                for (size_t i = page; i < std::min(page + 20, keys.size()); ++i, ++it) {
+                    ASSERT_EQ(it.get_key(), keys[i]);
+                }
+            };
+            for (int i = 0; i < 6000; ++i) {
+                auto key = std::to_string(gen() % 3000);
+                if (gen() % 3 == 0) {
+                    skipList.erase(key);
+                    expected.erase(key);
+                } else {
+                    skipList.insert(key, std::to_string(i));
+                    expected[key] = std::to_string(i);
+                }
+            }
+            check();
+            std::vector<std::pair<Key, Value>> batch;
+            for (int i = 0; i < 500; ++i) {
+                batch.emplace_back(std::to_string(gen() % 4000), "batch");
+            }
+            skipList.insert_batch(batch.begin(), batch.end());
+            for (auto &entry: batch) {
+                expected[entry.first] = entry.second;
+            }
+            check();
+            for (auto it = expected.begin(); it != expected.end();) {
+                skipList.erase(it->first);
+                it = expected.erase(it);
+                if (it != expected.end()) {
+                    ++it;
+                }
+            }
+            check();
+        }
+    }
+
+    // 批量构建后一次性计算跨度
+    SkipListOptions options;
+    options.seed = 1;
+    auto entries = std::vector<std::pair<int, int>>();
+    for (int i = 0; i < 5000; ++i) {
+        entries.emplace_back(i * 2, i);
+    }
+    // 相同的种子得到相同的塔高，两者的内存只差跨度
+    SkipList<int, int, IntComparator> plain(IntComparator(), entries.begin(), entries.end(), options);
+    options.indexable = true;
+    SkipList<int, int, IntComparator> ints(IntComparator(), entries.begin(), entries.end(), options);
+    EXPECT_EQ(ints.get_memory_usage(), plain.get_memory_usage() + ints.get_span_memory_usage());
+    EXPECT_GE(ints.get_span_memory_usage(), 5000 * sizeof(uint32_t));
+    for (int i = 0; i < 5000; i += 7) {
+        EXPECT_EQ(ints.at(i), std::make_optional(std::make_pair(i * 2, i)));
+        EXPECT_EQ(ints.rank(i * 2 + 1), static_cast<size_t>(i + 1));
+    }
+    ints.insert(-1, -1);
+    EXPECT_EQ(ints.at(1), std::make_optional(std::make_pair(0, 0)));
+    EXPECT_EQ(ints.rank(10000), 5001u);
+
+    // 内联存储的 string_view 字节位于跨度之后
+    SkipListOptions view_options;
+    view_options.indexable = true;
+    view_options.inline_key_prefix = true;
+    SkipList<std::string_view, std::string_view, TransparentComparator> views(TransparentComparator{},
+                                                                              view_options);
+    for (int i = 199; i >= 0; --i) {
+        std::string key = "key" + std::to_string(1000 + i);
+        views.insert(key, key + "-value");
+    }
+    for (int i = 0; i < 200; ++i) {
+        auto entry = views.at(i);
+        ASSERT_TRUE(entry.has_value());
+        EXPECT_EQ(entry->first, "key" + std::to_string(1000 + i));
+        EXPECT_EQ(entry->second, "key" + std::to_string(1000 + i) + "-value");
+    }
+}
+
+// 测试内联键前缀：前缀相同、长度不足 8 字节、含 '\0' 和高位字节的键
+TEST(SkipListTest, InlineKeyPrefix) {
+    EXPECT_LT(make_key_prefix("a"), make_key_prefix("b"));
+    EXPECT_LT(make_key_prefix("ab"), make_key_prefix("b"));
+    EXPECT_LT(make_key_prefix("zzzzzzz"), make_key_prefix(std::string("\x80", 1)));
+    EXPECT_EQ(make_key_prefix("abcdefgh1"), make_key_prefix("abcdefgh2"));
+
+    for (bool concurrent_readers: {false, true}) {
+        SkipListOptions options;
+        options.inline_key_prefix = true;
+        options.concurrent_readers = concurrent_readers;
+        Comparator cmp;
+        SkipList<Key, Value, Comparator> skipList(cmp, options);
+        std::map<Key, Value> expected;
+        const std::vector<std::string> stems = {"", "a", "ab", std::string("a\0b", 3), "abcdefgh",
+                                                "abcdefgh/shared/", "\xff\xfe", "user:"};
+        std::mt19937 gen(0);
+        for (int i = 0; i < 5000; ++i) {
+            auto key = stems[gen() % stems.size()] + std::to_string(gen() % 200);
+            if (gen() % 4 == 0) {
+                skipList.erase(key);
+                expected.erase(key);
+            } else {
+                skipList.insert(key, std::to_string(i));
+                expected[key] = std::to_string(i);
+            }
+        }
+        std::vector<std::pair<Key, Value>> result;
+        for (auto it = skipList.begin(); it != skipList.end(); ++it) {
+            result.emplace_back(it.get_key(), it.get_value());
+        }
+        EXPECT_EQ(result, (std::vector<std::pair<Key, Value>>(expected.begin(), expected.end())));
+        for (auto &stem: stems) {
+            auto key = stem + "100";
+            EXPECT_EQ(skipList.get(key), expected.count(key) ? std::optional<Value>(expected[key]) : std::nullopt);
+            auto it = expected.lower_bound(key);
+            auto sit = skipList.lower_bound(key);
+            EXPECT_EQ(sit.is_end() ? "<end>" : sit.get_key(), it == expected.end() ? "<end>" : it->first);
+        }
+
+        // 批量构建的节点同样带前缀
+        SkipList<Key, Value, Comparator> bulk(cmp, expected.begin(), expected.end(), options);
+        for (auto &[key, value]: expected) {
+            ASSERT_EQ(bulk.get(key).value(), value);
+        }
+        // 每个节点多占 8 字节
+        SkipListOptions plain_options;
+        plain_options.seed = 1;
+        options.seed = 1;
+        SkipList<Key, Value, Comparator> plain(cmp, expected.begin(), expected.end(), plain_options);
+        SkipList<Key, Value, Comparator> prefixed(cmp, expected.begin(), expected.end(), options);
+        EXPECT_EQ(prefixed.get_memory_usage() - plain.get_memory_usage(), expected.size() * sizeof(uint64_t));
+    }
+}
+
+// 测试 string_view 键值的内联存储：插入后源缓冲区失效不影响数据
+TEST(SkipListTest, InlineByteStrings) {
+    using View = std::string_view;
+    for (int mode = 0; mode < 4; ++mode) {
+        SkipListOptions options;
+        options.concurrent_readers = mode == 1;
+        options.use_arena = mode == 2;
+        options.inline_key_prefix = mode == 3;
+        SkipList<View, View, TransparentComparator> skipList(TransparentComparator{}, options);
+        std::map<std::string, std::string> expected;
+        std::mt19937 gen(mode);
+        for (int i = 0; i < 2000; ++i) {
+            std::string key = "key" + std::to_string(gen() % 300);
+            std::string value(gen() % 40, static_cast<char>('a' + i % 26));
+            if (gen() % 5 == 0) {
+                skipList.erase(key);
+                expected.erase(key);
+            } else {
+                skipList.insert(key, value);
+                expected[key] = value;
+            }
+            // 覆盖源缓冲区，跳表中保存的应是自己的副本
+            std::fill(key.begin(), key.end(), '#');
+            std::fill(value.begin(), value.end(), '#');
+        }
+        std::vector<std::pair<std::string, std::string>> result;
+        for (auto it = skipList.begin(); it != skipList.end(); ++it) {
+            result.emplace_back(it.get_key(), it.get_value());
+        }
+        EXPECT_EQ(result, (std::vector<std::pair<std::string, std::string>>(expected.begin(), expected.end())));
 
-    // EXPECT_EQ(result.size(), 3);
-    // EXPECT_EQ(result[0].first, "key1");
-    // EXPECT_EQ(result[1].first, "key2");
-    // EXPECT_EQ(result[2].first, "key3");
+        size_t expected_size = 0;
+        for (auto &[key, value]: expected) {
+            expected_size += key.size() + value.size();
+        }
+        EXPECT_EQ(skipList.get_size(), expected_size);
+        EXPECT_TRUE(skipList.get_with(expected.begin()->first, [&](const View &value) {
+            EXPECT_EQ(value, expected.begin()->second);
+        }));
+
+        // 批量构建同样复制键值
+        SkipList<View, View, TransparentComparator> bulk(TransparentComparator{}, expected.begin(), expected.end(),
+                                                         options);
+        for (auto &[key, value]: expected) {
+            ASSERT_EQ(bulk.get(key).value(), value);
+        }
+    }
 }
 
 // 测试大量数据插入和查找
@@ -254,151 +847,625 @@ TEST(SkipListTest, MemorySizeTracking) {
     // EXPECT_EQ(skipList.get_size(), 0);
 }
 
-// TEST(SkipListTest, IteratorPreffix) {
-//     SkipList skipList;
-//
-//     // 插入一些测试数据
-//     skipList.insert("apple", "0");
-//     skipList.insert("apple2", "1");
-//     skipList.insert("apricot", "2");
-//     skipList.insert("banana", "3");
-//     skipList.insert("berry", "4");
-//     skipList.insert("cherry", "5");
-//     skipList.insert("cherry2", "6");
-//
-//     // 测试前缀 "ap"
-//     auto it = skipList.begin_preffix("ap");
-//     EXPECT_EQ(it.get_key(), "apple");
-//
-//     // 测试前缀 "ba"
-//     it = skipList.begin_preffix("ba");
-//     EXPECT_EQ(it.get_key(), "banana");
-//
-//     // 测试前缀 "ch"
-//     it = skipList.begin_preffix("ch");
-//     EXPECT_EQ(it.get_key(), "cherry");
-//
-//     // 测试前缀 "z"
-//     it = skipList.begin_preffix("z");
-//     EXPECT_TRUE(it == skipList.end());
-//
-//     // 测试前缀 "berr"
-//     it = skipList.begin_preffix("berr");
-//     EXPECT_EQ(it.get_key(), "berry");
-//
-//     // 测试前缀 "a"
-//     it = skipList.begin_preffix("a");
-//     EXPECT_EQ(it.get_key(), "apple");
-//
-//     // 测试前缀结束位置
-//     it = skipList.end_preffix("a");
-//     EXPECT_EQ(it.get_key(), "banana");
-//
-//     it = skipList.end_preffix("cherry");
-//     EXPECT_TRUE(it == skipList.end());
-//
-//     EXPECT_EQ(skipList.begin_preffix("not exist"),
-//               skipList.end_preffix("not exist"));
-// }
+// 自定义类型：只统计有效载荷
+struct Payload {
+    int length;
+    char data[60];
+};
 
-// TEST(SkipListTest, ItersPredicate_Base) {
-//     SkipList skipList;
-//     skipList.insert("prefix1", "value1");
-//     skipList.insert("prefix2", "value2");
-//     skipList.insert("prefix3", "value3");
-//     skipList.insert("other", "value4");
-//     skipList.insert("longerkey", "value5");
-//     skipList.insert("averylongkey", "value6");
-//     skipList.insert("medium", "value7");
-//     skipList.insert("midway", "value8");
-//     skipList.insert("midpoint", "value9");
-//
-//     // 测试前缀匹配
-//     auto prefix_result =
-//             skipList.iters_monotony_predicate([](const std::string &key) {
-//                 auto match_str = key.substr(0, 3);
-//                 if (match_str == "pre") {
-//                     return 0;
-//                 } else if (match_str < "pre") {
-//                     return 1;
-//                 }
-//                 return -1;
-//             });
-//     ASSERT_TRUE(prefix_result.has_value());
-//     auto [prefix_begin_iter, prefix_end_iter] = prefix_result.value();
-//     EXPECT_EQ(prefix_begin_iter.get_key(), "prefix1");
-//     EXPECT_TRUE(prefix_end_iter.is_end());
-//
-//     EXPECT_EQ(prefix_begin_iter.get_value(), "value1");
-//     ++prefix_begin_iter;
-//     EXPECT_EQ(prefix_begin_iter.get_value(), "value2");
-//     ++prefix_begin_iter;
-//     EXPECT_EQ(prefix_begin_iter.get_value(), "value3");
-//
-//     // 测试范围匹配
-//     auto range = std::make_pair("l", "n"); // [l, n)
-//     auto range_result =
-//             skipList.iters_monotony_predicate([&range](const std::string &key) {
-//                 if (key < range.first) {
-//                     return 1;
-//                 } else if (key >= range.second) {
-//                     return -1;
-//                 } else {
-//                     return 0;
-//                 }
-//             });
-//     ASSERT_TRUE(range_result.has_value());
-//     auto [range_begin_iter, range_end_iter] = range_result.value();
-//     EXPECT_EQ(range_end_iter.get_key(),
-//               "other"); // end_iter 是开区间，所以指向 "prefix1"
-//     EXPECT_EQ(range_begin_iter.get_key(), "longerkey");
-//     ++range_begin_iter;
-//     EXPECT_EQ(range_begin_iter.get_key(), "medium");
-//     ++range_begin_iter;
-//     EXPECT_EQ(range_begin_iter.get_key(), "midpoint");
-//     ++range_begin_iter;
-//     EXPECT_EQ(range_begin_iter.get_key(), "midway");
-// }
+template<>
+struct SkipListSizeTraits<Payload> {
+    static size_t size(const Payload &payload) { return payload.length; }
 
-// TEST(SkipListTest, ItersPredicate_Large) {
-//     SkipList skipList;
-//     int num = 10000;
-//
-//     for (int i = 0; i < num; ++i) {
-//         std::ostringstream oss_key;
-//         std::ostringstream oss_value;
-//
-//         // 设置数字为4位长度，不足的部分用前导零填充
-//         oss_key << "key" << std::setw(4) << std::setfill('0') << i;
-//         oss_value << "value" << std::setw(4) << std::setfill('0') << i;
-//
-//         std::string key = oss_key.str();
-//         std::string value = oss_value.str();
-//
-//         skipList.insert(key, value);
-//     }
-//
-//     skipList.erase("key1015");
-//
-//     auto result = skipList.iters_monotony_predicate([](const std::string &key) {
-//         if (key < "key1010") {
-//             return 1;
-//         } else if (key >= "key1020") {
-//             return -1;
-//         } else {
-//             return 0;
-//         }
-//     });
-//
-//     ASSERT_TRUE(result.has_value());
-//     auto [range_begin_iter, range_end_iter] = result.value();
-//     EXPECT_EQ(range_begin_iter.get_key(), "key1010");
-//     EXPECT_EQ(range_end_iter.get_key(), "key1020");
-//     for (int i = 0; i < 5; i++) {
-//         range_begin_iter++;
-//     }
-//     EXPECT_EQ(range_begin_iter.get_key(), "key1016");
-// }
+    static size_t heap_size(const Payload &) { return 0; }
+};
+
+// 测试非字符串键值的大小统计和实际内存统计
+TEST(SkipListTest, MemoryUsageTracking) {
+    SkipList<int, int, IntComparator> skipList(IntComparator{});
+    auto empty_usage = skipList.get_memory_usage();
+    EXPECT_EQ(skipList.get_size(), 0);
+    EXPECT_GT(empty_usage, 0);  // 头节点
+
+    for (int i = 0; i < 100; ++i) {
+        skipList.insert(i * 1000, i);
+    }
+    EXPECT_EQ(skipList.get_size(), 100 * 2 * sizeof(int));
+    // 每个节点至少包含键值和一层前向指针
+    EXPECT_GE(skipList.get_memory_usage() - empty_usage,
+              100 * (2 * sizeof(int) + sizeof(void *)));
+
+    // 覆盖写不改变大小
+    skipList.insert(0, 42);
+    EXPECT_EQ(skipList.get_size(), 100 * 2 * sizeof(int));
+
+    for (int i = 0; i < 100; ++i) {
+        skipList.erase(i * 1000);
+    }
+    EXPECT_EQ(skipList.get_size(), 0);
+    EXPECT_EQ(skipList.get_memory_usage(), empty_usage);
+
+    // 长字符串的数据在堆上，计入实际内存；覆盖写按新旧值之差调整。
+    // 短字符串移动赋值时沿用原来的缓冲区，实际内存不变
+    Comparator cmp;
+    SkipList<Key, Value, Comparator> strings(cmp);
+    auto strings_empty = strings.get_memory_usage();
+    strings.insert("key", std::string(1000, 'v'));
+    EXPECT_EQ(strings.get_size(), 3 + 1000);
+    EXPECT_GE(strings.get_memory_usage() - strings_empty, 1000);
+    strings.insert("key", "v");
+    EXPECT_EQ(strings.get_size(), 3 + 1);
+    EXPECT_GE(strings.get_memory_usage() - strings_empty, 1000);
+    strings.erase("key");
+    EXPECT_EQ(strings.get_memory_usage(), strings_empty);
+
+    // 用户特化的大小策略
+    SkipList<int, Payload, IntComparator> payloads(IntComparator{});
+    payloads.insert(1, Payload{5, "hello"});
+    EXPECT_EQ(payloads.get_size(), sizeof(int) + 5);
+}
+
+// 测试批量写入：已排序、乱序、重复键，以及与已有数据交错
+TEST(SkipListTest, InsertBatch) {
+    IntComparator cmp;
+    for (bool concurrent_readers: {false, true}) {
+        SkipListOptions options;
+        options.concurrent_readers = concurrent_readers;
+        SkipList<int, int, IntComparator> skipList(cmp, options);
+        std::map<int, int> expected;
+
+        std::vector<std::pair<int, int>> sorted;
+        for (int i = 0; i < 1000; i += 2) {
+            sorted.emplace_back(i, i);
+        }
+        skipList.insert_batch(sorted.begin(), sorted.end());
+        for (auto &[key, value]: sorted) {
+            expected[key] = value;
+        }
+
+        std::mt19937 gen(0);
+        for (int round = 0; round < 20; ++round) {
+            std::vector<std::pair<int, int>> batch;
+            for (int i = 0; i < 100; ++i) {
+                batch.emplace_back(gen() % 1500, round * 1000 + i);
+            }
+            skipList.insert_batch(batch.begin(), batch.end());
+            // 重复的键以批次中最后一次写入为准
+            for (auto &[key, value]: batch) {
+                expected[key] = value;
+            }
+        }
+
+        std::vector<std::pair<int, int>> result;
+        for (auto it = skipList.begin(); it != skipList.end(); ++it) {
+            result.emplace_back(it.get_key(), it.get_value());
+        }
+        EXPECT_EQ(result, (std::vector<std::pair<int, int>>(expected.begin(), expected.end())));
+        EXPECT_EQ(skipList.get_size(), expected.size() * 2 * sizeof(int));
+    }
+
+    // 空批次和单个元素
+    SkipList<int, int, IntComparator> skipList(cmp);
+    std::vector<std::pair<int, int>> batch;
+    skipList.insert_batch(batch.begin(), batch.end());
+    EXPECT_TRUE(skipList.begin().is_end());
+    batch.emplace_back(1, 1);
+    skipList.insert_batch(batch.begin(), batch.end());
+    EXPECT_EQ(skipList.get(1).value(), 1);
+}
+
+// 测试由有序输入批量构建：单线程、多线程、Arena，以及乱序输入的退化路径
+TEST(SkipListTest, BulkLoad) {
+    IntComparator cmp;
+    std::vector<std::pair<int, int>> sorted;
+    for (int i = 0; i < 10000; ++i) {
+        sorted.emplace_back(i * 3, i);
+    }
+    auto check = [&](SkipList<int, int, IntComparator> &skipList) {
+        std::vector<std::pair<int, int>> result;
+        for (auto it = skipList.begin(); it != skipList.end(); ++it) {
+            result.emplace_back(it.get_key(), it.get_value());
+        }
+        EXPECT_EQ(result, sorted);
+        EXPECT_EQ(skipList.get_size(), sorted.size() * 2 * sizeof(int));
+        EXPECT_EQ(skipList.get(2997).value(), 999);
+        EXPECT_FALSE(skipList.contains(2998));
+        // 构建完成后仍可正常插入和删除
+        skipList.insert(2998, -1);
+        EXPECT_EQ(skipList.get(2998).value(), -1);
+        skipList.erase(2998);
+        skipList.erase(0);
+        EXPECT_FALSE(skipList.contains(0));
+        skipList.insert(0, 0);
+    };
+
+    for (int threads: {1, 4}) {
+        BulkLoadOptions bulk_options;
+        bulk_options.threads = threads;
+        SkipList<int, int, IntComparator> skipList(cmp, sorted.begin(), sorted.end(), {}, bulk_options);
+        check(skipList);
+    }
+
+    SkipListOptions arena_options;
+    arena_options.use_arena = true;
+    BulkLoadOptions parallel;
+    parallel.threads = 4;
+    SkipList<int, int, IntComparator> arena_list(cmp, sorted.begin(), sorted.end(), arena_options, parallel);
+    check(arena_list);
+
+    // 固定种子时多线程构建的结构也可复现
+    SkipListOptions seeded;
+    seeded.seed = 11;
+    SkipList<int, int, IntComparator> a(cmp, sorted.begin(), sorted.end(), seeded, parallel);
+    SkipList<int, int, IntComparator> b(cmp, sorted.begin(), sorted.end(), seeded, parallel);
+    EXPECT_EQ(a.get_memory_usage(), b.get_memory_usage());
+
+    // 乱序且有重复时按 insert_batch 处理
+    auto shuffled = sorted;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(0));
+    shuffled.emplace_back(3, 1);
+    SkipList<int, int, IntComparator> unsorted(cmp, shuffled.begin(), shuffled.end());
+    check(unsorted);
+
+    // 空输入和 move_iterator
+    SkipList<int, int, IntComparator> empty(cmp, sorted.end(), sorted.end());
+    EXPECT_TRUE(empty.begin().is_end());
+    std::vector<std::pair<Key, Value>> strings = {{"a", std::string(100, 'a')}, {"b", "b"}};
+    SkipList<Key, Value, Comparator> moved(Comparator(), std::make_move_iterator(strings.begin()),
+                                           std::make_move_iterator(strings.end()));
+    EXPECT_EQ(moved.get("a").value(), std::string(100, 'a'));
+    EXPECT_TRUE(strings[0].second.empty());
+}
+
+// 测试塔高分布：塔高至少为 k 的比例应接近 p^(k-1)，且不超过 max_level
+TEST(SkipListTest, LevelGenerator) {
+    const int draws = 1 << 16;
+    for (float p: {0.5f, 0.25f}) {
+        LevelGenerator levels(8, p);
+        Random64 rng(42);
+        std::vector<int> at_least(10, 0);
+        for (int i = 0; i < draws; ++i) {
+            int level = levels.level(rng.next());
+            ASSERT_GE(level, 1);
+            ASSERT_LE(level, 8);
+            for (int k = 1; k <= level; ++k) {
+                ++at_least[k];
+            }
+        }
+        EXPECT_EQ(at_least[1], draws);
+        for (int k = 2; k <= 4; ++k) {
+            double expected = std::pow(p, k - 1);
+            EXPECT_NEAR(static_cast<double>(at_least[k]) / draws, expected, expected * 0.1);
+        }
+    }
+    EXPECT_EQ(LevelGenerator(8, 0.5).level(0), 8);
+    EXPECT_EQ(LevelGenerator(8, 0.25).level(0), 8);
+    EXPECT_EQ(LevelGenerator(8, 0.25).level(UINT64_MAX), 1);
+}
+
+// 测试固定种子：相同的插入序列得到相同的结构
+TEST(SkipListTest, DeterministicSeed) {
+    SkipListOptions options;
+    options.seed = 7;
+    Comparator cmp;
+    SkipList<Key, Value, Comparator> a(cmp, options);
+    SkipList<Key, Value, Comparator> b(cmp, options);
+    for (int i = 0; i < 1000; ++i) {
+        a.insert(std::to_string(i), "v");
+        b.insert(std::to_string(i), "v");
+    }
+    // 节点内存取决于每个节点的塔高
+    EXPECT_EQ(a.get_memory_usage(), b.get_memory_usage());
+
+    Random64 x(7), y(7);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(x.next(), y.next());
+    }
+}
+
+// 测试 Arena 模式
+TEST(SkipListTest, ArenaMode) {
+    Comparator cmp;
+    SkipListOptions options;
+    options.use_arena = true;
+    SkipList<Key, Value, Comparator> skipList(cmp, options);
+    const int num_elements = 10000;
+
+    size_t initial_usage = skipList.get_arena_usage();
+    EXPECT_GT(initial_usage, 0); // 头节点也分配在 Arena 中
+
+    for (int i = 0; i < num_elements; ++i) {
+        skipList.insert("key" + std::to_string(i), "value" + std::to_string(i));
+    }
+    EXPECT_GT(skipList.get_arena_usage(), initial_usage);
+
+    for (int i = 0; i < num_elements; i += 2) {
+        skipList.erase("key" + std::to_string(i));
+    }
+    for (int i = 0; i < num_elements; ++i) {
+        auto result = skipList.get("key" + std::to_string(i));
+        if (i % 2 == 0) {
+            EXPECT_FALSE(result.has_value());
+        } else {
+            EXPECT_EQ(result.value(), "value" + std::to_string(i));
+        }
+    }
+
+    // 堆模式下不占用 Arena
+    SkipList<Key, Value, Comparator> heapList(cmp);
+    heapList.insert("key", "value");
+    EXPECT_EQ(heapList.get_arena_usage(), 0);
+}
+
+struct PmrComparator {
+    int operator()(const std::pmr::string &a, const std::pmr::string &b) const {
+        return a.compare(b);
+    }
+};
+
+// 测试 pmr 字符串的数据也分配在 Arena 中
+TEST(SkipListTest, ArenaModePmrString) {
+    PmrComparator cmp;
+    SkipListOptions options;
+    options.use_arena = true;
+    SkipList<std::pmr::string, std::pmr::string, PmrComparator> skipList(cmp, options);
+
+    size_t initial_usage = skipList.get_arena_usage();
+    std::pmr::string value(1 << 16, 'v'); // 远大于 SSO 的值
+    skipList.insert("key", value);
+    EXPECT_GE(skipList.get_arena_usage(), initial_usage + value.size());
+    EXPECT_EQ(skipList.get("key").value(), value);
+}
+
+// 测试单写多读模式：一个写线程插入、覆盖和删除，多个读线程无锁查找
+TEST(SkipListTest, SingleWriterMultiReader) {
+    Comparator cmp;
+    SkipListOptions options;
+    options.concurrent_readers = true;
+    SkipList<Key, Value, Comparator> skipList(cmp, options);
+    const int num_readers = 4;
+    const int num_keys = 1000;
+    const int num_operations = 50000;
+
+    // 偶数键始终存在，读者必须总能找到
+    for (int id = 0; id < num_keys; id += 2) {
+        skipList.insert("key" + std::to_string(id), "value" + std::to_string(id) + "_0");
+    }
+
+    std::atomic<bool> writer_done{false};
+    std::atomic<int> bad_reads{0};
+
+    std::thread writer([&] {
+        std::mt19937 gen(0);
+        for (int i = 0; i < num_operations; ++i) {
+            int id = static_cast<int>(gen() % num_keys);
+            std::string key = "key" + std::to_string(id);
+            if (id % 2 == 1 && gen() % 2 == 0) {
+                skipList.erase(key);
+            } else {
+                skipList.insert(key, "value" + std::to_string(id) + "_" + std::to_string(i));
+            }
+        }
+        writer_done = true;
+    });
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < num_readers; ++t) {
+        readers.emplace_back([&, t] {
+            std::mt19937 gen(t + 1);
+            for (int i = 0; !writer_done; ++i) {
+                // 定期做一次有序遍历，迭代器持有 epoch，遍历期间节点不会被释放
+                if (i % 100 == 0) {
+                    std::string last;
+                    for (auto it = skipList.begin(); it != skipList.end(); ++it) {
+                        if (!last.empty() && it.get_key() <= last) {
+                            ++bad_reads;
+                        }
+                        last = it.get_key();
+                    }
+                }
+                int id = static_cast<int>(gen() % num_keys);
+                auto result = skipList.get("key" + std::to_string(id));
+                if (id % 2 == 0 && !result.has_value()) {
+                    ++bad_reads;
+                } else if (result.has_value() &&
+                           result->rfind("value" + std::to_string(id) + "_", 0) != 0) {
+                    ++bad_reads;
+                }
+            }
+        });
+    }
+
+    writer.join();
+    for (auto &reader: readers) {
+        reader.join();
+    }
+    EXPECT_EQ(bad_reads.load(), 0);
+    for (int id = 0; id < num_keys; id += 2) {
+        EXPECT_TRUE(skipList.contains("key" + std::to_string(id)));
+    }
+}
+
+// 测试单写多读模式下被删除的节点会被及时回收
+TEST(SkipListTest, EpochReclamation) {
+    Comparator cmp;
+    SkipListOptions options;
+    options.concurrent_readers = true;
+    SkipList<Key, Value, Comparator> skipList(cmp, options);
+    const int num_elements = 10000;
+
+    for (int i = 0; i < num_elements; ++i) {
+        skipList.insert("key" + std::to_string(i), "value" + std::to_string(i));
+    }
+    for (int i = 0; i < num_elements; ++i) {
+        skipList.erase("key" + std::to_string(i));
+    }
+    // 没有读者时，退休节点每隔一批就会被释放，不会全部堆积到析构
+    EXPECT_GT(skipList.get_peak_retired_size(), 0);
+    EXPECT_LT(skipList.get_peak_retired_size(), 64 * 1024);
+    EXPECT_LE(skipList.get_retired_size(), skipList.get_peak_retired_size());
+}
+
+static int g_freed_count = 0;
+
+// 测试读者登记期间退休的对象不会被释放
+TEST(EpochManagerTest, GuardBlocksReclamation) {
+    g_freed_count = 0;
+    auto deleter = [](void *ptr, void *) {
+        delete static_cast<int *>(ptr);
+        ++g_freed_count;
+    };
+    {
+        EpochManager epoch;
+        {
+            auto guard = epoch.pin();
+            epoch.retire(new int(1), deleter, nullptr, sizeof(int));
+            epoch.reclaim();
+            EXPECT_EQ(g_freed_count, 0);
+            EXPECT_EQ(epoch.retired_bytes(), sizeof(int));
+        }
+        // 读者离开后可以回收
+        epoch.reclaim();
+        EXPECT_EQ(g_freed_count, 1);
+        EXPECT_EQ(epoch.retired_bytes(), 0);
+
+        // 读者 a 阻止对象 2 被回收；之后才登记的读者 b 看不到对象 2，
+        // a 离开后即可回收，但 b 会阻止它登记之后退休的对象 3
+        std::optional<EpochManager::Guard> a(epoch.pin());
+        epoch.retire(new int(2), deleter, nullptr, sizeof(int));
+        epoch.reclaim();
+        EXPECT_EQ(g_freed_count, 1);
+        auto b = epoch.pin();
+        a.reset();
+        epoch.reclaim();
+        EXPECT_EQ(g_freed_count, 2);
+        epoch.retire(new int(3), deleter, nullptr, sizeof(int));
+        epoch.reclaim();
+        EXPECT_EQ(g_freed_count, 2);
+        EXPECT_EQ(epoch.peak_retired_bytes(), sizeof(int));
+    }
+    // 析构时释放剩余对象
+    EXPECT_EQ(g_freed_count, 3);
+}
+
+// 同时登记的线程多于槽位数时，多出的线程登记到溢出槽位而不等待，
+// 溢出槽位非空期间不回收，全部离开后照常回收
+TEST(EpochManagerTest, MoreThreadsThanSlots) {
+    g_freed_count = 0;
+    auto deleter = [](void *ptr, void *) {
+        delete static_cast<int *>(ptr);
+        ++g_freed_count;
+    };
+    EpochManager epoch;
+    const int num_threads = 200;
+    std::atomic<int> pinned{0};
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&] {
+            auto guard = epoch.pin();
+            ++pinned;
+            released.wait();
+        });
+    }
+    while (pinned < num_threads) {
+        std::this_thread::yield();
+    }
+    epoch.retire(new int(1), deleter, nullptr, sizeof(int));
+    epoch.reclaim();
+    EXPECT_EQ(g_freed_count, 0);
+    release.set_value();
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    epoch.reclaim();
+    EXPECT_EQ(g_freed_count, 1);
+    EXPECT_EQ(epoch.retired_bytes(), 0u);
+}
+
+// 一个线程持有的迭代器多于槽位数时，超出的部分共用本线程的槽位，
+// 不会卡住；其他线程仍能登记，全部迭代器销毁后退休节点可以回收
+TEST(EpochManagerTest, MoreIteratorsThanSlots) {
+    SkipListOptions options;
+    options.concurrent_readers = true;
+    SkipList<Key, Value, Comparator> skipList(Comparator(), options);
+    const int num_iterators = 300;
+    for (int i = 0; i < num_iterators; ++i) {
+        skipList.insert("key" + std::to_string(1000 + i), "value" + std::to_string(i));
+    }
+    std::vector<SkipList<Key, Value, Comparator>::Iterator> iterators;
+    for (int i = 0; i < num_iterators; ++i) {
+        iterators.push_back(skipList.lower_bound("key" + std::to_string(1000 + i)));
+    }
+    // 迭代器存活期间删除的节点不会被释放，迭代器仍可安全访问
+    for (int i = 0; i < num_iterators; ++i) {
+        skipList.erase("key" + std::to_string(1000 + i));
+    }
+    EXPECT_GT(skipList.get_retired_size(), 0u);
+    std::thread([&] {
+        EXPECT_FALSE(skipList.contains("key1000"));
+    }).join();
+    for (int i = 0; i < num_iterators; ++i) {
+        ASSERT_FALSE(iterators[i].is_end());
+        ASSERT_EQ(iterators[i].get_value(), "value" + std::to_string(i));
+    }
+
+    iterators.clear();
+    for (int i = 0; i < 200; ++i) {
+        skipList.insert("key", "value");
+    }
+    EXPECT_LT(skipList.get_retired_size(), skipList.get_peak_retired_size());
+}
+
+TEST(SkipListTest, IteratorPreffix) {
+    Comparator cmp;
+    SkipList<Key, Value, Comparator> skipList(cmp);
+
+    // 插入一些测试数据
+    skipList.insert("apple", "0");
+    skipList.insert("apple2", "1");
+    skipList.insert("apricot", "2");
+    skipList.insert("banana", "3");
+    skipList.insert("berry", "4");
+    skipList.insert("cherry", "5");
+    skipList.insert("cherry2", "6");
+
+    // 测试前缀 "ap"
+    auto it = skipList.begin_preffix("ap");
+    EXPECT_EQ(it.get_key(), "apple");
+
+    // 测试前缀 "ba"
+    it = skipList.begin_preffix("ba");
+    EXPECT_EQ(it.get_key(), "banana");
+
+    // 测试前缀 "ch"
+    it = skipList.begin_preffix("ch");
+    EXPECT_EQ(it.get_key(), "cherry");
+
+    // 测试前缀 "z"
+    it = skipList.begin_preffix("z");
+    EXPECT_TRUE(it == skipList.end());
+
+    // 测试前缀 "berr"
+    it = skipList.begin_preffix("berr");
+    EXPECT_EQ(it.get_key(), "berry");
+
+    // 测试前缀 "a"
+    it = skipList.begin_preffix("a");
+    EXPECT_EQ(it.get_key(), "apple");
+
+    // 测试前缀结束位置
+    it = skipList.end_preffix("a");
+    EXPECT_EQ(it.get_key(), "banana");
+
+    it = skipList.end_preffix("cherry");
+    EXPECT_TRUE(it == skipList.end());
+
+    EXPECT_EQ(skipList.begin_preffix("not exist"),
+              skipList.end_preffix("not exist"));
+}
+
+TEST(SkipListTest, ItersPredicate_Base) {
+    Comparator cmp;
+    SkipList<Key, Value, Comparator> skipList(cmp);
+    skipList.insert("prefix1", "value1");
+    skipList.insert("prefix2", "value2");
+    skipList.insert("prefix3", "value3");
+    skipList.insert("other", "value4");
+    skipList.insert("longerkey", "value5");
+    skipList.insert("averylongkey", "value6");
+    skipList.insert("medium", "value7");
+    skipList.insert("midway", "value8");
+    skipList.insert("midpoint", "value9");
+
+    // 测试前缀匹配
+    auto prefix_result =
+            skipList.iters_monotony_predicate([](const std::string &key) {
+                auto match_str = key.substr(0, 3);
+                if (match_str == "pre") {
+                    return 0;
+                } else if (match_str < "pre") {
+                    return 1;
+                }
+                return -1;
+            });
+    ASSERT_TRUE(prefix_result.has_value());
+    auto [prefix_begin_iter, prefix_end_iter] = prefix_result.value();
+    EXPECT_EQ(prefix_begin_iter.get_key(), "prefix1");
+    EXPECT_TRUE(prefix_end_iter.is_end());
+
+    EXPECT_EQ(prefix_begin_iter.get_value(), "value1");
+    ++prefix_begin_iter;
+    EXPECT_EQ(prefix_begin_iter.get_value(), "value2");
+    ++prefix_begin_iter;
+    EXPECT_EQ(prefix_begin_iter.get_value(), "value3");
+
+    // 测试范围匹配
+    auto range = std::make_pair("l", "n"); // [l, n)
+    auto range_result =
+            skipList.iters_monotony_predicate([&range](const std::string &key) {
+                if (key < range.first) {
+                    return 1;
+                } else if (key >= range.second) {
+                    return -1;
+                } else {
+                    return 0;
+                }
+            });
+    ASSERT_TRUE(range_result.has_value());
+    auto [range_begin_iter, range_end_iter] = range_result.value();
+    EXPECT_EQ(range_end_iter.get_key(),
+              "other"); // end_iter 是开区间，所以指向 "prefix1"
+    EXPECT_EQ(range_begin_iter.get_key(), "longerkey");
+    ++range_begin_iter;
+    EXPECT_EQ(range_begin_iter.get_key(), "medium");
+    ++range_begin_iter;
+    EXPECT_EQ(range_begin_iter.get_key(), "midpoint");
+    ++range_begin_iter;
+    EXPECT_EQ(range_begin_iter.get_key(), "midway");
+}
+
+TEST(SkipListTest, ItersPredicate_Large) {
+    Comparator cmp;
+    SkipList<Key, Value, Comparator> skipList(cmp);
+    int num = 10000;
+
+    for (int i = 0; i < num; ++i) {
+        std::ostringstream oss_key;
+        std::ostringstream oss_value;
+
+        // 设置数字为4位长度，不足的部分用前导零填充
+        oss_key << "key" << std::setw(4) << std::setfill('0') << i;
+        oss_value << "value" << std::setw(4) << std::setfill('0') << i;
+
+        std::string key = oss_key.str();
+        std::string value = oss_value.str();
+
+        skipList.insert(key, value);
+    }
+
+    skipList.erase("key1015");
+
+    auto result = skipList.iters_monotony_predicate([](const std::string &key) {
+        if (key < "key1010") {
+            return 1;
+        } else if (key >= "key1020") {
+            return -1;
+        } else {
+            return 0;
+        }
+    });
+
+    ASSERT_TRUE(result.has_value());
+    auto [range_begin_iter, range_end_iter] = result.value();
+    EXPECT_EQ(range_begin_iter.get_key(), "key1010");
+    EXPECT_EQ(range_end_iter.get_key(), "key1020");
+    for (int i = 0; i < 5; i++) {
+        range_begin_iter++;
+    }
+    EXPECT_EQ(range_begin_iter.get_key(), "key1016");
+}
 
 // ! 现在的实现, 并发的锁由 SkipList 的上层 MemTable 实现, 因此不需要测试
 // SkipList 的并发性
@@ -543,6 +1610,1047 @@ TEST(SkipListTest, MemorySizeTracking) {
 //             num_writers * num_operations); // 跳表大小不应超过最大可能值
 // }
 
+// 测试并发跳表的基本插入、查找和删除
+TEST(ConcurrentSkipListTest, BasicOperations) {
+    Comparator cmp;
+    ConcurrentSkipList<Key, Value, Comparator> skipList(cmp);
+
+    skipList.insert("key1", "value1");
+    EXPECT_EQ(skipList.get("key1").value(), "value1");
+
+    skipList.insert("key1", "new_value");
+    EXPECT_EQ(skipList.get("key1").value(), "new_value");
+    EXPECT_EQ(skipList.get_size(), sizeof("key1") - 1 + sizeof("new_value") - 1);
+
+    skipList.erase("key1");
+    EXPECT_FALSE(skipList.contains("key1"));
+    EXPECT_EQ(skipList.get_size(), 0);
+
+    // 逻辑删除后再次插入
+    skipList.insert("key1", "value2");
+    EXPECT_EQ(skipList.get("key1").value(), "value2");
+    skipList.erase("nonexistent_key");
+}
+
+// erase 只做逻辑删除，purge 摘除这些节点；读线程与 purge 并发
+TEST(ConcurrentSkipListTest, PurgeErased) {
+    Comparator cmp;
+    ConcurrentSkipList<Key, Value, Comparator> skipList(cmp);
+    const int num_keys = 5000;
+    for (int i = 0; i < num_keys; ++i) {
+        skipList.insert("key" + std::to_string(i), "value" + std::to_string(i));
+    }
+    for (int i = 0; i < num_keys; i += 2) {
+        skipList.erase("key" + std::to_string(i));
+    }
+    EXPECT_EQ(skipList.get_erased_count(), num_keys / 2);
+    // 再次插入复用节点
+    skipList.insert("key0", "value0");
+    EXPECT_EQ(skipList.get_erased_count(), num_keys / 2 - 1);
+
+    std::atomic<bool> done{false};
+    std::atomic<int> bad_reads{0};
+    std::thread reader([&] {
+        std::mt19937 gen(0);
+        while (!done) {
+            int id = static_cast<int>(gen() % num_keys);
+            std::string key = "key" + std::to_string(id);
+            bool expected = id == 0 || id % 2 == 1;
+            if (skipList.contains(key) != expected) {
+                ++bad_reads;
+            }
+            auto result = skipList.get(key);
+            if (result.has_value() != expected ||
+                (expected && *result != "value" + std::to_string(id))) {
+                ++bad_reads;
+            }
+        }
+    });
+    skipList.purge();
+    EXPECT_EQ(skipList.get_erased_count(), 0u);
+    done = true;
+    reader.join();
+    EXPECT_EQ(bad_reads.load(), 0);
+
+    for (int i = 0; i < num_keys; ++i) {
+        std::string key = "key" + std::to_string(i);
+        ASSERT_EQ(skipList.contains(key), i == 0 || i % 2 == 1);
+    }
+    // 摘除后再插入的键链入新节点
+    skipList.insert("key2", "new");
+    EXPECT_EQ(skipList.get("key2").value(), "new");
+    EXPECT_EQ(skipList.get_erased_count(), 0u);
+}
+
+// 多个线程同时插入互不相同的键
+TEST(ConcurrentSkipListTest, ConcurrentInsert) {
+    Comparator cmp;
+    ConcurrentSkipList<Key, Value, Comparator> skipList(cmp);
+    const int num_threads = 8;
+    const int num_operations = 10000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 gen(t);
+            std::vector<int> ids(num_operations);
+            for (int i = 0; i < num_operations; ++i) {
+                ids[i] = i * num_threads + t;
+            }
+            std::shuffle(ids.begin(), ids.end(), gen);
+            for (int id: ids) {
+                skipList.insert("key" + std::to_string(id), "value" + std::to_string(id));
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    size_t expected_size = 0;
+    for (int id = 0; id < num_threads * num_operations; ++id) {
+        std::string key = "key" + std::to_string(id);
+        std::string value = "value" + std::to_string(id);
+        ASSERT_EQ(skipList.get(key).value(), value);
+        expected_size += key.size() + value.size();
+    }
+    EXPECT_EQ(skipList.get_size(), expected_size);
+}
+
+// 多个线程竞争插入、覆盖和删除同一批键，同时有读线程不断查找
+TEST(ConcurrentSkipListTest, ConcurrentOperations) {
+    Comparator cmp;
+    ConcurrentSkipList<Key, Value, Comparator> skipList(cmp);
+    const int num_readers = 4;
+    const int num_writers = 4;
+    const int num_keys = 1000;
+    const int num_operations = 20000;
+
+    std::atomic<bool> start{false};
+    std::atomic<bool> writers_done{false};
+    std::atomic<int> bad_reads{0};
+
+    auto writer_func = [&](int thread_id) {
+        while (!start) {
+            std::this_thread::yield();
+        }
+        std::mt19937 gen(thread_id);
+        for (int i = 0; i < num_operations; ++i) {
+            int id = static_cast<int>(gen() % num_keys);
+            std::string key = "key" + std::to_string(id);
+            if (gen() % 4 == 0) {
+                skipList.erase(key);
+            } else {
+                skipList.insert(key, "value" + std::to_string(id) + "_" + std::to_string(thread_id));
+            }
+        }
+    };
+
+    auto reader_func = [&](int thread_id) {
+        while (!start) {
+            std::this_thread::yield();
+        }
+        std::mt19937 gen(num_writers + thread_id);
+        while (!writers_done) {
+            int id = static_cast<int>(gen() % num_keys);
+            auto result = skipList.get("key" + std::to_string(id));
+            // 读到的值必须是某个写线程为该键写入的完整值
+            if (result.has_value() && result->rfind("value" + std::to_string(id) + "_", 0) != 0) {
+                ++bad_reads;
+            }
+        }
+    };
+
+    std::vector<std::thread> writers;
+    for (int i = 0; i < num_writers; ++i) {
+        writers.emplace_back(writer_func, i);
+    }
+    std::vector<std::thread> readers;
+    for (int i = 0; i < num_readers; ++i) {
+        readers.emplace_back(reader_func, i);
+    }
+    start = true;
+    for (auto &w: writers) {
+        w.join();
+    }
+    writers_done = true;
+    for (auto &r: readers) {
+        r.join();
+    }
+    EXPECT_EQ(bad_reads.load(), 0);
+
+    // 所有写线程结束后，大小统计应与实际内容一致
+    size_t expected_size = 0;
+    for (int id = 0; id < num_keys; ++id) {
+        std::string key = "key" + std::to_string(id);
+        auto result = skipList.get(key);
+        if (result.has_value()) {
+            expected_size += key.size() + result->size();
+        }
+    }
+    EXPECT_EQ(skipList.get_size(), expected_size);
+}
+
+// 哈希分片：点操作落在各自分片，分片大小之和等于总大小，归并迭代有序
+TEST(ShardedSkipListTest, HashSharding) {
+    IntComparator cmp;
+    ShardedSkipList<int, int, IntComparator> list(cmp, 8);
+    EXPECT_EQ(list.mode(), ShardingMode::kHash);
+    EXPECT_EQ(list.shard_count(), 8u);
+    EXPECT_TRUE(list.begin().is_end());
+
+    std::map<int, int> expected;
+    std::mt19937 gen(42);
+    for (int i = 0; i < 5000; ++i) {
+        int key = static_cast<int>(gen() % 2000);
+        if (gen() % 4 == 0) {
+            list.erase(key);
+            expected.erase(key);
+        } else {
+            list.insert(key, i);
+            expected[key] = i;
+        }
+    }
+
+    size_t shard_sum = 0;
+    size_t non_empty = 0;
+    for (size_t i = 0; i < list.shard_count(); ++i) {
+        shard_sum += list.get_shard_size(i);
+        non_empty += list.get_shard_size(i) > 0;
+    }
+    EXPECT_EQ(shard_sum, list.get_size());
+    EXPECT_EQ(list.get_size(), expected.size() * 2 * sizeof(int));
+    EXPECT_EQ(non_empty, list.shard_count());
+
+    for (int key = 0; key < 2000; ++key) {
+        auto it = expected.find(key);
+        ASSERT_EQ(list.contains(key), it != expected.end());
+        if (it != expected.end()) {
+            ASSERT_EQ(list.get(key).value(), it->second);
+        }
+    }
+
+    std::vector<std::pair<int, int>> merged(list.begin(), list.end());
+    std::vector<std::pair<int, int>> want_all(expected.begin(), expected.end());
+    EXPECT_EQ(merged, want_all);
+
+    auto it = list.lower_bound(1000);
+    ASSERT_FALSE(it.is_end());
+    EXPECT_EQ(it.get_key(), expected.lower_bound(1000)->first);
+
+    std::vector<int> scanned;
+    list.scan(100, 200, [&](int key, int) { scanned.push_back(key); });
+    std::vector<int> want;
+    for (auto e = expected.lower_bound(100); e != expected.lower_bound(200); ++e) {
+        want.push_back(e->first);
+    }
+    EXPECT_EQ(scanned, want);
+}
+
+// 范围分片：键按分割键落入对应分片，跨分片的扫描与迭代保持有序
+TEST(ShardedSkipListTest, RangeSharding) {
+    Comparator cmp;
+    ShardedSkipList<Key, Value, Comparator> list(cmp, std::vector<Key>{"c", "f", "m"});
+    EXPECT_EQ(list.mode(), ShardingMode::kRange);
+    EXPECT_EQ(list.shard_count(), 4u);
+    EXPECT_EQ(list.shard_index("a"), 0u);
+    EXPECT_EQ(list.shard_index("c"), 1u);
+    EXPECT_EQ(list.shard_index("ez"), 1u);
+    EXPECT_EQ(list.shard_index("f"), 2u);
+    EXPECT_EQ(list.shard_index("z"), 3u);
+
+    for (char c = 'a'; c <= 'z'; ++c) {
+        list.insert(std::string(1, c), std::string(1, c - 'a' + 'A'));
+    }
+    EXPECT_EQ(list.get_shard_size(0), 2u * 2);
+    EXPECT_EQ(list.get_shard_size(1), 3u * 2);
+    EXPECT_EQ(list.get_shard_size(2), 7u * 2);
+    EXPECT_EQ(list.get_shard_size(3), 14u * 2);
+    EXPECT_EQ(list.get_size(), 26u * 2);
+
+    std::string keys;
+    for (auto [key, value]: list) {
+        keys += key;
+        EXPECT_EQ(value[0], key[0] - 'a' + 'A');
+    }
+    EXPECT_EQ(keys, "abcdefghijklmnopqrstuvwxyz");
+
+    // 清空中间的分片后，迭代与 lower_bound 跳过空分片
+    for (char c = 'c'; c < 'f'; ++c) {
+        list.erase(std::string(1, c));
+    }
+    EXPECT_EQ(list.get_shard_size(1), 0u);
+    auto it = list.lower_bound("bb");
+    ASSERT_FALSE(it.is_end());
+    EXPECT_EQ(it.get_key(), "f");
+    EXPECT_TRUE(list.lower_bound("zz").is_end());
+
+    // 跨分片扫描，回调返回 false 时提前结束
+    std::string scanned;
+    list.scan("b", "p", [&](const Key &key, const Value &) {
+        scanned += key;
+        return scanned.size() < 6;
+    });
+    EXPECT_EQ(scanned, "bfghij");
+
+    scanned.clear();
+    list.scan("ee", "h", [&](const Key &key, const Value &) { scanned += key; });
+    EXPECT_EQ(scanned, "fg");
+}
+
+// 多个写线程并发写入各分片，同时有读线程查找
+TEST(ShardedSkipListTest, ConcurrentWriters) {
+    for (bool concurrent_readers: {false, true}) {
+        SkipListOptions options;
+        options.concurrent_readers = concurrent_readers;
+        ShardedSkipList<Key, Value, Comparator> hashed(Comparator(), 16, options);
+        std::vector<Key> splits;
+        for (int i = 1; i < 8; ++i) {
+            splits.push_back("key" + std::to_string(i));
+        }
+        ShardedSkipList<Key, Value, Comparator> ranged(Comparator(), splits, options);
+
+        const int num_threads = 4;
+        const int num_operations = 5000;
+        std::atomic<bool> writers_done{false};
+        std::atomic<int> bad_reads{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < num_operations; ++i) {
+                    int id = i * num_threads + t;
+                    std::string key = "key" + std::to_string(id);
+                    hashed.insert(key, "value" + std::to_string(id));
+                    ranged.insert(key, "value" + std::to_string(id));
+                }
+            });
+        }
+        std::thread reader([&] {
+            std::mt19937 gen(7);
+            while (!writers_done) {
+                int id = static_cast<int>(gen() % (num_threads * num_operations));
+                std::string key = "key" + std::to_string(id);
+                for (auto *list: {&hashed, &ranged}) {
+                    auto result = list->get(key);
+                    if (result.has_value() && *result != "value" + std::to_string(id)) {
+                        ++bad_reads;
+                    }
+                }
+            }
+        });
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        writers_done = true;
+        reader.join();
+        EXPECT_EQ(bad_reads.load(), 0);
+
+        size_t expected_size = 0;
+        for (int id = 0; id < num_threads * num_operations; ++id) {
+            std::string key = "key" + std::to_string(id);
+            std::string value = "value" + std::to_string(id);
+            ASSERT_EQ(hashed.get(key).value(), value);
+            ASSERT_EQ(ranged.get(key).value(), value);
+            expected_size += key.size() + value.size();
+        }
+        EXPECT_EQ(hashed.get_size(), expected_size);
+        EXPECT_EQ(ranged.get_size(), expected_size);
+        EXPECT_TRUE(std::equal(hashed.begin(), hashed.end(), ranged.begin(), ranged.end()));
+    }
+}
+
+// 写满后冻结并换表，后台按冻结顺序刷盘，读操作从新到旧查找
+TEST(MemTableTest, FreezeAndFlush) {
+    using Table = MemTable<Key, Value, Comparator>::Table;
+    std::mutex flushed_mutex;
+    std::vector<std::vector<std::pair<Key, std::optional<Value>>>> flushed;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+
+    MemTableOptions options;
+    options.flush_threshold = 56;
+    MemTable<Key, Value, Comparator> memtable(Comparator(), options, [&](const Table &table) {
+        released.wait();
+        std::lock_guard<std::mutex> lock(flushed_mutex);
+        flushed.emplace_back(table.begin(), table.end());
+    });
+
+    // 每条 14 字节，第 4 条写入后冻结
+    for (int i = 0; i < 4; ++i) {
+        memtable.insert("key" + std::to_string(i), "value0000" + std::to_string(i));
+    }
+    EXPECT_EQ(memtable.get_immutable_count(), 1u);
+    EXPECT_EQ(memtable.get_active_size(), 0u);
+
+    // 新表中的覆盖写和删除标记遮蔽不可变表中的旧值
+    memtable.insert("key1", "new");
+    memtable.erase("key2");
+    EXPECT_EQ(memtable.get("key0").value(), "value00000");
+    EXPECT_EQ(memtable.get("key1").value(), "new");
+    EXPECT_FALSE(memtable.contains("key2"));
+    EXPECT_FALSE(memtable.get("missing").has_value());
+
+    memtable.freeze();
+    EXPECT_EQ(memtable.get_immutable_count(), 2u);
+    memtable.freeze();  // 活跃表为空，不产生新的不可变表
+    EXPECT_EQ(memtable.get_immutable_count(), 2u);
+    EXPECT_EQ(memtable.get("key1").value(), "new");
+    EXPECT_FALSE(memtable.contains("key2"));
+
+    release.set_value();
+    memtable.wait_for_flush();
+    EXPECT_EQ(memtable.get_immutable_count(), 0u);
+    EXPECT_EQ(memtable.get_flushed_count(), 2u);
+    EXPECT_FALSE(memtable.contains("key0"));
+
+    std::lock_guard<std::mutex> lock(flushed_mutex);
+    ASSERT_EQ(flushed.size(), 2u);
+    EXPECT_EQ(flushed[0].size(), 4u);
+    EXPECT_EQ(flushed[0][1], (std::pair<Key, std::optional<Value>>("key1", "value00001")));
+    ASSERT_EQ(flushed[1].size(), 2u);
+    EXPECT_EQ(flushed[1][0], (std::pair<Key, std::optional<Value>>("key1", "new")));
+    EXPECT_EQ(flushed[1][1], (std::pair<Key, std::optional<Value>>("key2", std::nullopt)));
+}
+
+// 只有删除时，删除标记占满活跃表同样触发换表
+TEST(MemTableTest, EraseOnlyRotation) {
+    using Table = MemTable<Key, Value, Comparator>::Table;
+    std::atomic<size_t> flushed_entries{0};
+    MemTableOptions options;
+    options.flush_threshold = 56;
+    MemTable<Key, Value, Comparator> memtable(Comparator(), options, [&](const Table &table) {
+        flushed_entries += std::distance(table.begin(), table.end());
+    });
+
+    // 删除标记只计键的 4 字节，第 14 条写入后冻结
+    for (int i = 0; i < 13; ++i) {
+        memtable.erase("k" + std::to_string(100 + i));
+    }
+    EXPECT_EQ(memtable.get_active_size(), 52u);
+    memtable.erase("k113");
+    EXPECT_EQ(memtable.get_active_size(), 0u);
+    for (int i = 14; i < 70; ++i) {
+        memtable.erase("k" + std::to_string(100 + i));
+    }
+    memtable.wait_for_flush();
+    EXPECT_EQ(memtable.get_flushed_count(), 5u);
+    EXPECT_EQ(flushed_entries, 70u);
+    EXPECT_EQ(memtable.get_active_size(), 0u);
+}
+
+// 读线程在不断换表和刷盘的同时查找最近写入的键，查到的值必须完整
+TEST(MemTableTest, ReadDuringRotation) {
+    using Table = MemTable<Key, Value, Comparator>::Table;
+    std::atomic<size_t> flushed_entries{0};
+    MemTableOptions options;
+    options.flush_threshold = 1024;
+    MemTable<Key, Value, Comparator> memtable(Comparator(), options, [&](const Table &table) {
+        flushed_entries += std::distance(table.begin(), table.end());
+    });
+
+    const int num_keys = 20000;
+    std::atomic<int> written{0};
+    std::atomic<int> bad_reads{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 2; ++t) {
+        readers.emplace_back([&, t] {
+            std::mt19937 gen(t);
+            while (written < num_keys) {
+                int limit = written;
+                if (limit == 0) {
+                    continue;
+                }
+                // 已刷盘的键查不到，此处不做要求
+                int id = limit - 1 - static_cast<int>(gen() % std::min(limit, 16));
+                auto result = memtable.get("key" + std::to_string(id));
+                if (result.has_value() && *result != "value" + std::to_string(id)) {
+                    ++bad_reads;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < num_keys; ++i) {
+        memtable.insert("key" + std::to_string(i), "value" + std::to_string(i));
+        written = i + 1;
+    }
+    for (auto &reader: readers) {
+        reader.join();
+    }
+    EXPECT_EQ(bad_reads.load(), 0);
+
+    memtable.freeze();
+    memtable.wait_for_flush();
+    EXPECT_GT(memtable.get_flushed_count(), 100u);
+    EXPECT_EQ(flushed_entries.load(), static_cast<size_t>(num_keys));
+}
+
+// 扫描合并活跃表与不可变表：同一个键取最新的记录，删除标记遮住旧表中的键
+TEST(MemTableTest, ScanAcrossTables) {
+    using Table = MemTable<Key, Value, Comparator>::Table;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    MemTable<Key, Value, Comparator> memtable(Comparator(), MemTableOptions(), [&](const Table &) {
+        released.wait();  // 测试期间不可变表保持在内存中
+    });
+    memtable.insert("a", "1");
+    memtable.insert("b", "1");
+    memtable.insert("c", "1");
+    memtable.freeze();
+    memtable.insert("b", "2");
+    memtable.erase("c");
+    memtable.insert("d", "2");
+    memtable.freeze();
+    memtable.insert("a", "3");
+    memtable.insert("e", "3");
+    EXPECT_EQ(memtable.get_immutable_count(), 2u);
+
+    std::vector<std::pair<Key, Value>> result;
+    memtable.scan("a", "z", [&](const Key &key, const Value &value) { result.emplace_back(key, value); });
+    EXPECT_EQ(result, (std::vector<std::pair<Key, Value>>{{"a", "3"}, {"b", "2"}, {"d", "2"}, {"e", "3"}}));
+
+    result.clear();
+    memtable.scan("b", "e", [&](const Key &key, const Value &value) {
+        result.emplace_back(key, value);
+        return result.size() < 1;
+    });
+    EXPECT_EQ(result, (std::vector<std::pair<Key, Value>>{{"b", "2"}}));
+    release.set_value();
+}
+
+// 与按从旧到新依次写入的 std::map 对照：遍历、来源下标与 seek
+TEST(MergingIteratorTest, NewestWins) {
+    using List = SkipList<int, int, IntComparator>;
+    std::mt19937 gen(0);
+    for (int n: {0, 1, 2, 3, 5, 8}) {
+        std::vector<std::unique_ptr<List>> lists;
+        std::vector<const List *> sources;
+        for (int i = 0; i < n; ++i) {
+            lists.push_back(std::make_unique<List>(IntComparator()));
+            sources.push_back(lists.back().get());
+        }
+        // 来源 i 中的值为 i，键在来源之间大量重叠
+        std::map<int, int> expected;
+        for (int i = n - 1; i >= 0; --i) {
+            for (int j = 0; j < 300; ++j) {
+                int key = static_cast<int>(gen() % 500);
+                lists[i]->insert(key, i);
+                expected[key] = i;
+            }
+        }
+        MergingIterator<int, int, IntComparator> it(sources, IntComparator());
+        std::vector<std::pair<int, int>> result;
+        for (; !it.is_end(); ++it) {
+            EXPECT_EQ(it.get_source(), static_cast<size_t>(it.get_value()));
+            result.emplace_back(it.get_key(), it.get_value());
+        }
+        EXPECT_EQ(result, (std::vector<std::pair<int, int>>(expected.begin(), expected.end())));
+
+        for (int key: {-1, 0, 250, 251, 499, 500}) {
+            it.seek(key);
+            auto e = expected.lower_bound(key);
+            if (e == expected.end()) {
+                EXPECT_TRUE(it.is_end());
+                continue;
+            }
+            ASSERT_FALSE(it.is_end());
+            EXPECT_EQ(it.get_key(), e->first);
+            EXPECT_EQ(it.get_value(), e->second);
+            ++it;
+            ++e;
+            EXPECT_EQ(it.is_end() ? -1 : it.get_key(), e == expected.end() ? -1 : e->first);
+        }
+        it.seek_to_first();
+        EXPECT_EQ(it.is_end(), expected.empty());
+    }
+}
+
+std::string WalTestPath(const std::string &name) {
+    std::string path = ::testing::TempDir() + "skiplist_" + name + ".wal";
+    std::remove(path.c_str());
+    return path;
+}
+
+// 记录按写入顺序回放；截断或损坏的尾部被丢弃，之后的写入接在最后一条完整记录后
+TEST(WalTest, ReplayAndTornTail) {
+    using Type = WriteAheadLog::RecordType;
+    std::string path = WalTestPath("replay");
+    {
+        WriteAheadLog wal(path);
+        wal.append(Type::kInsert, "a", "1");
+        wal.append(Type::kInsert, "b", "");
+        wal.append(Type::kErase, "a", "");
+        EXPECT_EQ(wal.get_record_count(), 3u);
+        EXPECT_EQ(wal.get_sync_count(), 3u);
+    }
+
+    std::vector<std::tuple<Type, std::string, std::string>> records;
+    auto collect = [&](Type type, std::string_view key, std::string_view value) {
+        records.emplace_back(type, std::string(key), std::string(value));
+    };
+    {
+        WriteAheadLog wal(path, {}, collect);
+        EXPECT_EQ(wal.get_replayed_count(), 3u);
+    }
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[0], std::make_tuple(Type::kInsert, std::string("a"), std::string("1")));
+    EXPECT_EQ(records[1], std::make_tuple(Type::kInsert, std::string("b"), std::string("")));
+    EXPECT_EQ(records[2], std::make_tuple(Type::kErase, std::string("a"), std::string("")));
+
+    // 模拟崩溃时写了一半的记录
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out.write("\x12\x34\x56\x78\x20\x00\x00\x00\x01key", 12);
+    }
+    records.clear();
+    {
+        WriteAheadLog wal(path, {}, collect);
+        EXPECT_EQ(wal.get_replayed_count(), 3u);
+        wal.append(Type::kInsert, "c", "3");
+    }
+    records.clear();
+    {
+        WriteAheadLog wal(path, {}, collect);
+        EXPECT_EQ(wal.get_replayed_count(), 4u);
+    }
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[3], std::make_tuple(Type::kInsert, std::string("c"), std::string("3")));
+
+    // 翻转最后一条记录中的一个字节，校验失败后只回放之前的记录
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-1, std::ios::end);
+        file.put('X');
+    }
+    {
+        WriteAheadLog wal(path);
+        EXPECT_EQ(wal.get_replayed_count(), 3u);
+    }
+    std::remove(path.c_str());
+}
+
+// 并发写者共享组提交，重启后由日志恢复出同样的跳表
+TEST(WalTest, GroupCommitAndRecovery) {
+    for (auto policy: {WalSyncPolicy::kEveryWrite, WalSyncPolicy::kInterval, WalSyncPolicy::kNone}) {
+        std::string path = WalTestPath("recovery");
+        WalOptions wal_options;
+        wal_options.sync = policy;
+        wal_options.sync_interval_ms = 1;
+        const int num_threads = 8;
+        const int num_operations = 500;
+        std::map<Key, Value> expected;
+        {
+            DurableSkipList<Key, Value, Comparator> list(Comparator(), path, wal_options);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < num_threads; ++t) {
+                threads.emplace_back([&, t] {
+                    for (int i = 0; i < num_operations; ++i) {
+                        std::string key = "key" + std::to_string(i * num_threads + t);
+                        list.insert(key, "value" + std::to_string(i));
+                        if (i % 5 == 0) {
+                            list.erase(key);
+                        }
+                    }
+                });
+            }
+            for (auto &thread: threads) {
+                thread.join();
+            }
+            // 每个 erase 前的 insert 在它之前生效
+            for (int id = 0; id < num_threads * num_operations; ++id) {
+                int i = id / num_threads;
+                if (i % 5 != 0) {
+                    expected["key" + std::to_string(id)] = "value" + std::to_string(i);
+                }
+            }
+            auto &wal = list.wal();
+            EXPECT_EQ(wal.get_record_count(), num_threads * num_operations * 6u / 5);
+            EXPECT_LE(wal.get_group_count(), wal.get_record_count());
+            if (policy == WalSyncPolicy::kEveryWrite) {
+                EXPECT_EQ(wal.get_sync_count(), wal.get_group_count());
+            } else if (policy == WalSyncPolicy::kNone) {
+                EXPECT_EQ(wal.get_sync_count(), 0u);
+            }
+            EXPECT_EQ(std::distance(list.list().begin(), list.list().end()),
+                      static_cast<std::ptrdiff_t>(expected.size()));
+        }
+
+        DurableSkipList<Key, Value, Comparator> recovered(Comparator(), path, wal_options);
+        EXPECT_EQ(recovered.wal().get_replayed_count(), num_threads * num_operations * 6u / 5);
+        std::vector<std::pair<Key, Value>> contents(recovered.list().begin(), recovered.list().end());
+        std::vector<std::pair<Key, Value>> want(expected.begin(), expected.end());
+        EXPECT_EQ(contents, want);
+
+        // 回放后继续写入
+        recovered.insert("key0", "again");
+        EXPECT_EQ(recovered.get("key0").value(), "again");
+        std::remove(path.c_str());
+    }
+}
+
+// 整数键值按内存表示记录，string_view 键值回放时逐条插入
+TEST(WalTest, Codecs) {
+    std::string path = WalTestPath("codecs");
+    {
+        DurableSkipList<int, double, IntComparator> list(IntComparator(), path);
+        for (int i = 0; i < 100; ++i) {
+            list.insert(i, i * 0.5);
+        }
+        list.erase(7);
+    }
+    {
+        DurableSkipList<int, double, IntComparator> list(IntComparator(), path);
+        EXPECT_EQ(list.get(10).value(), 5.0);
+        EXPECT_FALSE(list.contains(7));
+    }
+    // 校验和正确但长度与类型不符的记录：用不同的值类型打开，或值为空
+    using List = DurableSkipList<int, int, IntComparator>;
+    EXPECT_THROW(List(IntComparator(), path), std::runtime_error);
+    std::remove(path.c_str());
+    {
+        WriteAheadLog wal(path);
+        int key = 1;
+        wal.append(WriteAheadLog::RecordType::kInsert,
+                   std::string_view(reinterpret_cast<const char *>(&key), sizeof(key)), "");
+    }
+    EXPECT_THROW(List(IntComparator(), path), std::runtime_error);
+    std::remove(path.c_str());
+
+    path = WalTestPath("codecs_view");
+    {
+        DurableSkipList<std::string_view, std::string_view, TransparentComparator> list(
+            TransparentComparator(), path);
+        std::string key = "view";
+        list.insert(key, "value");
+        list.erase("gone");
+    }
+    {
+        DurableSkipList<std::string_view, std::string_view, TransparentComparator> list(
+            TransparentComparator(), path);
+        EXPECT_EQ(list.get("view").value(), "value");
+    }
+    std::remove(path.c_str());
+}
+
+// 用 RLIMIT_FSIZE 让一组写入只写出一部分：写了一半的记录被截断，
+// 之后确认的记录在重启后都能回放
+TEST(WalTest, ShortWriteIsTruncated) {
+    using Type = WriteAheadLog::RecordType;
+    std::string path = WalTestPath("short_write");
+    rlimit old_limit{};
+    ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &old_limit), 0);
+    auto old_handler = std::signal(SIGXFSZ, SIG_IGN);
+    {
+        WriteAheadLog wal(path);
+        wal.append(Type::kInsert, "a", "1");
+        off_t size = std::ifstream(path, std::ios::binary | std::ios::ate).tellg();
+        rlimit limit = old_limit;
+        limit.rlim_cur = size + 64;
+        ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limit), 0);
+        EXPECT_THROW(wal.append(Type::kInsert, "big", std::string(4096, 'x')), std::system_error);
+        ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &old_limit), 0);
+        EXPECT_EQ(std::ifstream(path, std::ios::binary | std::ios::ate).tellg(), size);
+        wal.append(Type::kInsert, "b", "2");
+        wal.append(Type::kErase, "a", "");
+        EXPECT_EQ(wal.get_record_count(), 3u);
+    }
+    std::signal(SIGXFSZ, old_handler);
+
+    std::vector<std::string> keys;
+    {
+        WriteAheadLog wal(path, {}, [&](Type, std::string_view key, std::string_view) {
+            keys.emplace_back(key);
+        });
+        EXPECT_EQ(wal.get_replayed_count(), 3u);
+    }
+    EXPECT_EQ(keys, (std::vector<std::string>{"a", "b", "a"}));
+    std::remove(path.c_str());
+}
+
+// 跳表写成 SST 后，点查只读一个数据块，范围扫描跨块有序
+TEST(SstTest, WriteAndRead) {
+    std::string path = ::testing::TempDir() + "skiplist_table.sst";
+    SkipList<Key, Value, Comparator> list{Comparator()};
+    std::map<Key, Value> expected;
+    for (int i = 0; i < 20000; ++i) {
+        // 带公共前缀的键，检验前缀压缩与重启点
+        std::string key = "user:" + std::to_string(100000 + i * 3);
+        std::string value = "value" + std::string(i % 50, 'x');
+        list.insert(key, value);
+        expected[key] = value;
+    }
+    SstOptions options;
+    options.write_buffer_size = 4 * kSstAlignment;
+    uint64_t file_size = write_sst(list, path, options);
+
+    SstReader reader(path);
+    EXPECT_EQ(reader.get_entry_count(), expected.size());
+    EXPECT_GT(reader.get_block_count(), 100u);
+    // 前缀压缩后文件小于键值的原始大小
+    EXPECT_LT(file_size, list.get_size());
+
+    std::string value;
+    for (int i = 0; i < 20000; i += 97) {
+        std::string key = "user:" + std::to_string(100000 + i * 3);
+        uint64_t reads = reader.get_block_reads();
+        ASSERT_EQ(reader.get(key, &value), SstReader::LookupResult::kFound);
+        EXPECT_EQ(value, expected[key]);
+        EXPECT_EQ(reader.get_block_reads(), reads + 1);
+        // 相邻的不存在的键
+        ASSERT_EQ(reader.get(key + "0", &value), SstReader::LookupResult::kNotFound);
+    }
+    EXPECT_EQ(reader.get("a", &value), SstReader::LookupResult::kNotFound);
+    EXPECT_EQ(reader.get("z", &value), SstReader::LookupResult::kNotFound);
+    EXPECT_FALSE(reader.seek("z").valid());
+
+    // 全表遍历
+    auto want = expected.begin();
+    for (auto it = reader.begin(); it.valid(); it.next(), ++want) {
+        ASSERT_NE(want, expected.end());
+        ASSERT_EQ(it.key(), want->first);
+        ASSERT_EQ(it.value(), want->second);
+    }
+    EXPECT_EQ(want, expected.end());
+
+    // 范围扫描与提前结束
+    std::vector<std::string> scanned;
+    reader.scan("user:110000", "user:120000", [&](std::string_view key, std::string_view) {
+        scanned.emplace_back(key);
+        return true;
+    });
+    std::vector<std::string> want_keys;
+    for (auto e = expected.lower_bound("user:110000"); e != expected.lower_bound("user:120000"); ++e) {
+        want_keys.push_back(e->first);
+    }
+    EXPECT_EQ(scanned, want_keys);
+    size_t count = 0;
+    reader.scan("", "zzz", [&](std::string_view, std::string_view) { return ++count < 10; });
+    EXPECT_EQ(count, 10u);
+    std::remove(path.c_str());
+}
+
+// MemTable 的表中的删除标记写入 SST，空表和损坏的文件
+TEST(SstTest, DeletionsAndCorruption) {
+    std::string path = ::testing::TempDir() + "skiplist_deletions.sst";
+    using Table = MemTable<Key, Value, Comparator>::Table;
+    SkipListOptions options;
+    Table table(Comparator(), options);
+    table.insert("a", std::optional<Value>("1"));
+    table.insert("b", std::nullopt);
+    table.insert("c", std::optional<Value>(""));
+    write_sst(table, path);
+    {
+        SstReader reader(path);
+        std::string value;
+        EXPECT_EQ(reader.get("a", &value), SstReader::LookupResult::kFound);
+        EXPECT_EQ(value, "1");
+        EXPECT_EQ(reader.get("b", &value), SstReader::LookupResult::kDeleted);
+        EXPECT_EQ(reader.get("c", &value), SstReader::LookupResult::kFound);
+        EXPECT_EQ(value, "");
+        std::string scanned;
+        reader.scan("a", "d", [&](std::string_view key, std::string_view) {
+            scanned += key;
+            return true;
+        });
+        EXPECT_EQ(scanned, "ac");
+    }
+
+    Table empty(Comparator(), options);
+    write_sst(empty, path);
+    {
+        SstReader reader(path);
+        EXPECT_EQ(reader.get_entry_count(), 0u);
+        EXPECT_FALSE(reader.begin().valid());
+        std::string value;
+        EXPECT_EQ(reader.get("a", &value), SstReader::LookupResult::kNotFound);
+    }
+
+    write_sst(table, path);
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(2);
+        file.put('X');
+    }
+    {
+        SstReader reader(path);
+        std::string value;
+        EXPECT_THROW(reader.get("a", &value), std::runtime_error);
+    }
+    // 校验和正确但没有重启点的数据块
+    write_sst(table, path);
+    {
+        std::string contents;
+        {
+            std::ifstream file(path, std::ios::binary);
+            contents.assign(std::istreambuf_iterator<char>(file), {});
+        }
+        // 只有一个数据块，紧跟其后的是它的校验和与索引块
+        size_t block_size = get_fixed64(contents.data() + contents.size() - 32) - 4;
+        std::memset(&contents[block_size - 4], 0, 4);
+        uint32_t crc = crc32c(contents.data(), block_size);
+        std::memcpy(&contents[block_size], &crc, sizeof(crc));
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << contents;
+    }
+    {
+        SstReader reader(path);
+        std::string value;
+        EXPECT_THROW(reader.get("a", &value), std::runtime_error);
+    }
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << "not an sst file at all, but long enough";
+    }
+    EXPECT_THROW(SstReader reader(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+// 整数键按数值序编码，含负数时同样可以写出并逐个读回；乱序写入抛出异常
+TEST(SstTest, IntKeys) {
+    std::string path = ::testing::TempDir() + "skiplist_int_keys.sst";
+    SkipList<int, int, IntComparator> list{IntComparator()};
+    for (int i = -500; i < 500; ++i) {
+        list.insert(i * 7919, i);
+    }
+    list.insert(std::numeric_limits<int>::min(), 1);
+    list.insert(std::numeric_limits<int>::max(), 2);
+    write_sst(list, path);
+
+    SstReader reader(path);
+    EXPECT_EQ(reader.get_entry_count(), 1002u);
+    std::string key;
+    std::string value;
+    for (auto it = list.begin(); !it.is_end(); ++it) {
+        key.clear();
+        SstKeyCodec<int>::encode(it.get_key(), &key);
+        ASSERT_EQ(reader.get(key, &value), SstReader::LookupResult::kFound);
+        EXPECT_EQ(WalCodec<int>::decode(value), it.get_value());
+    }
+    key.clear();
+    SstKeyCodec<int>::encode(1, &key);
+    EXPECT_EQ(reader.get(key, &value), SstReader::LookupResult::kNotFound);
+    auto want = list.begin();
+    for (auto it = reader.begin(); it.valid(); it.next(), ++want) {
+        ASSERT_FALSE(want.is_end());
+        EXPECT_EQ(SstKeyCodec<int>::decode(it.key()), want.get_key());
+    }
+    EXPECT_TRUE(want.is_end());
+
+    SstWriter writer(path);
+    writer.add("b", "1");
+    EXPECT_THROW(writer.add("a", "2"), std::invalid_argument);
+    EXPECT_THROW(writer.add_deletion("b"), std::invalid_argument);
+    writer.add("c", "3");
+    writer.finish();
+    std::remove(path.c_str());
+}
+
+// 每次写入产生新版本，快照读到的是快照时刻的值，删除标记遮蔽旧版本
+TEST(VersionedSkipListTest, SnapshotReads) {
+    VersionedSkipList<Key, Value, Comparator> list{Comparator()};
+    auto empty = list.get_snapshot();
+    EXPECT_EQ(list.insert("a", "a1"), 1u);
+    EXPECT_EQ(list.insert("b", "b1"), 2u);
+    auto s2 = list.get_snapshot();
+    list.insert("a", "a2");
+    EXPECT_EQ(list.erase("b"), 4u);
+    list.insert("c", "c1");
+    auto s5 = list.get_snapshot();
+    list.insert("b", "b2");
+    EXPECT_EQ(list.get_last_sequence(), 6u);
+
+    EXPECT_FALSE(list.get("a", empty).has_value());
+    EXPECT_EQ(list.get("a", s2).value(), "a1");
+    EXPECT_EQ(list.get("b", s2).value(), "b1");
+    EXPECT_FALSE(list.contains("c", s2));
+    EXPECT_EQ(list.get("a", s5).value(), "a2");
+    EXPECT_FALSE(list.contains("b", s5));
+    EXPECT_EQ(list.get("b").value(), "b2");
+    EXPECT_FALSE(list.get("0").has_value());
+    EXPECT_FALSE(list.get("z").has_value());
+
+    auto collect = [&](VersionedSkipList<Key, Value, Comparator>::Snapshot snapshot) {
+        std::string out;
+        for (auto it = list.begin(snapshot); !it.is_end(); ++it) {
+            out += it.get_key() + "=" + it.get_value() + ";";
+        }
+        return out;
+    };
+    EXPECT_EQ(collect(empty), "");
+    EXPECT_EQ(collect(s2), "a=a1;b=b1;");
+    EXPECT_EQ(collect(s5), "a=a2;c=c1;");
+    EXPECT_EQ(collect(list.get_snapshot()), "a=a2;b=b2;c=c1;");
+
+    auto it = list.lower_bound("b", s5);
+    ASSERT_FALSE(it.is_end());
+    EXPECT_EQ(it.get_key(), "c");
+    EXPECT_EQ(it.get_sequence(), 5u);
+
+    std::string scanned;
+    list.scan("a", "c", [&](const Key &key, const Value &value) { scanned += key + value; }, s2);
+    EXPECT_EQ(scanned, "aa1bb1");
+
+    // 内部表按 (用户键, 序列号降序) 保存全部版本
+    std::vector<std::pair<std::string, uint64_t>> versions;
+    for (auto v = list.list().begin(); !v.is_end(); ++v) {
+        versions.emplace_back(v.get_key().user_key, v.get_key().sequence);
+    }
+    std::vector<std::pair<std::string, uint64_t>> want = {
+        {"a", 3}, {"a", 1}, {"b", 6}, {"b", 4}, {"b", 2}, {"c", 5}};
+    EXPECT_EQ(versions, want);
+}
+
+// 写线程不断转账（两个键一增一减），读线程在最近一次完成的转账的
+// 序列号上扫描：扫描期间写入继续进行，但总和始终不变
+TEST(VersionedSkipListTest, StableScansDuringWrites) {
+    using List = VersionedSkipList<int, int, IntComparator>;
+    List list{IntComparator()};
+    const int num_accounts = 64;
+    for (int i = 0; i < num_accounts; ++i) {
+        list.insert(i, 100);
+    }
+    std::atomic<uint64_t> committed{list.get_last_sequence()};
+    std::atomic<bool> done{false};
+    std::atomic<int> bad_scans{0};
+    std::atomic<int> scans{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 2; ++t) {
+        readers.emplace_back([&] {
+            while (!done) {
+                List::Snapshot snapshot{committed.load()};
+                int sum = 0;
+                int count = 0;
+                for (auto it = list.begin(snapshot); !it.is_end(); ++it) {
+                    sum += it.get_value();
+                    ++count;
+                    // 同一快照下点查与扫描的结果一致
+                    if (list.get(it.get_key(), snapshot).value() != it.get_value()) {
+                        ++bad_scans;
+                    }
+                }
+                if (sum != num_accounts * 100 || count != num_accounts) {
+                    ++bad_scans;
+                }
+                ++scans;
+            }
+        });
+    }
+    std::mt19937 gen(1);
+    std::vector<int> balance(num_accounts, 100);
+    for (int i = 0; i < 20000 || scans < 10; ++i) {
+        int from = static_cast<int>(gen() % num_accounts);
+        int to = static_cast<int>(gen() % num_accounts);
+        balance[from] -= 1;
+        list.insert(from, balance[from]);
+        balance[to] += 1;
+        committed = list.insert(to, balance[to]);
+    }
+    done = true;
+    for (auto &reader: readers) {
+        reader.join();
+    }
+    EXPECT_EQ(bad_scans.load(), 0);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();